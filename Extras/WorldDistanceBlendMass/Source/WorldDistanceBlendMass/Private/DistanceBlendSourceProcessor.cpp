@@ -0,0 +1,128 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "DistanceBlendSourceProcessor.h"
+
+#include "DistanceBlendMassTypes.h"
+#include "MassCommonFragments.h"
+#include "MassExecutionContext.h"
+#include "WorldDistanceBlendSubsystem.h"
+#include "Engine/World.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(DistanceBlendSourceProcessor)
+
+namespace DistanceBlend::Mass
+{
+	static UWorldDistanceBlendSubsystem* GetSubsystem(const UWorld* World, const TSubclassOf<UWorldDistanceBlendSubsystem>& SubsystemClass)
+	{
+		if (!World || !SubsystemClass)
+		{
+			return nullptr;
+		}
+		return Cast<UWorldDistanceBlendSubsystem>(World->GetSubsystemBase(SubsystemClass));
+	}
+}
+
+UDistanceBlendSourceProcessor::UDistanceBlendSourceProcessor()
+	: EntityQuery(*this)
+{
+	ExecutionFlags = static_cast<int32>(EProcessorExecutionFlags::All);
+	ProcessingPhase = EMassProcessingPhase::PostPhysics;
+	bRequiresGameThreadExecution = true;
+}
+
+void UDistanceBlendSourceProcessor::ConfigureQueries()
+{
+	EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FDistanceBlendSourceFragment>(EMassFragmentAccess::ReadWrite);
+}
+
+void UDistanceBlendSourceProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	UWorldDistanceBlendSubsystem* Subsystem = DistanceBlend::Mass::GetSubsystem(EntityManager.GetWorld(), SubsystemClass);
+	if (!Subsystem)
+	{
+		return;
+	}
+
+	// Push every source before evaluating so the weights reflect this frame
+	EntityQuery.ForEachEntityChunk(EntityManager, Context, [Subsystem](FMassExecutionContext& ChunkContext)
+	{
+		const TConstArrayView<FTransformFragment> Transforms = ChunkContext.GetFragmentView<FTransformFragment>();
+		const TArrayView<FDistanceBlendSourceFragment> Sources = ChunkContext.GetMutableFragmentView<FDistanceBlendSourceFragment>();
+
+		for (int32 Index = 0; Index < ChunkContext.GetNumEntities(); Index++)
+		{
+			FDistanceBlendSourceFragment& Source = Sources[Index];
+			const FVector Location = Transforms[Index].GetTransform().GetLocation();
+			if (!Source.Handle.IsValid())
+			{
+				Source.Handle = Subsystem->RegisterBlendSource(Location, Source.BlendScalar, Source.MaxRelevanceRadius);
+			}
+			else
+			{
+				Subsystem->SetBlendSourceLocation(Source.Handle, Location);
+				Subsystem->SetBlendSourceScalar(Source.Handle, Source.BlendScalar);
+			}
+		}
+	});
+
+	// Fetch the packed weights once and index them by slot, rather than looking each weight up through the subsystem
+	bool bValid = false;
+	const TConstArrayView<float> Weights = Subsystem->GetPackedBlendWeights(bValid, bDistanceXY);
+
+	EntityQuery.ForEachEntityChunk(EntityManager, Context, [Subsystem, Weights, bValid](FMassExecutionContext& ChunkContext)
+	{
+		const TArrayView<FDistanceBlendSourceFragment> Sources = ChunkContext.GetMutableFragmentView<FDistanceBlendSourceFragment>();
+		if (!bValid)
+		{
+			for (FDistanceBlendSourceFragment& Source : Sources)
+			{
+				Source.BlendWeight = 0.f;
+			}
+			return;
+		}
+
+		for (FDistanceBlendSourceFragment& Source : Sources)
+		{
+			const int32 Slot = Subsystem->GetBlendSourceSlot(Source.Handle);
+			Source.BlendWeight = Weights.IsValidIndex(Slot) ? Weights[Slot] : 0.f;
+		}
+	});
+}
+
+UDistanceBlendSourceRemovalObserver::UDistanceBlendSourceRemovalObserver()
+	: EntityQuery(*this)
+{
+	ObservedType = FDistanceBlendSourceFragment::StaticStruct();
+	Operation = EMassObservedOperation::Remove;
+	ExecutionFlags = static_cast<int32>(EProcessorExecutionFlags::All);
+	bRequiresGameThreadExecution = true;
+}
+
+void UDistanceBlendSourceRemovalObserver::ConfigureQueries()
+{
+	EntityQuery.AddRequirement<FDistanceBlendSourceFragment>(EMassFragmentAccess::ReadWrite);
+}
+
+void UDistanceBlendSourceRemovalObserver::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	UWorldDistanceBlendSubsystem* Subsystem = DistanceBlend::Mass::GetSubsystem(EntityManager.GetWorld(), SubsystemClass);
+	if (!Subsystem)
+	{
+		return;
+	}
+
+	EntityQuery.ForEachEntityChunk(EntityManager, Context, [Subsystem](FMassExecutionContext& ChunkContext)
+	{
+		const TArrayView<FDistanceBlendSourceFragment> Sources = ChunkContext.GetMutableFragmentView<FDistanceBlendSourceFragment>();
+		for (FDistanceBlendSourceFragment& Source : Sources)
+		{
+			if (Source.Handle.IsValid())
+			{
+				Subsystem->UnregisterBlendSource(Source.Handle);
+				Source.Handle.Reset();
+			}
+		}
+	});
+}
@@ -0,0 +1,18 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "WorldDistanceBlendMass.h"
+
+#define LOCTEXT_NAMESPACE "FWorldDistanceBlendMassModule"
+
+void FWorldDistanceBlendMassModule::StartupModule()
+{
+}
+
+void FWorldDistanceBlendMassModule::ShutdownModule()
+{
+}
+
+#undef LOCTEXT_NAMESPACE
+
+IMPLEMENT_MODULE(FWorldDistanceBlendMassModule, WorldDistanceBlendMass)
@@ -0,0 +1,34 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "DistanceBlendTypes.h"
+#include "DistanceBlendMassTypes.generated.h"
+
+/**
+ * Makes a Mass entity a distance blend source without an actor or component
+ * Requires FTransformFragment, the entity location is pushed to the subsystem by UDistanceBlendSourceProcessor
+ */
+USTRUCT()
+struct WORLDDISTANCEBLENDMASS_API FDistanceBlendSourceFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	/** Runtime scaling of this source's weight, equivalent to UDistanceBlendComponent::GetBlendScalar() */
+	UPROPERTY(EditAnywhere, Category = DistanceBlend)
+	float BlendScalar = 1.f;
+
+	/** Radius beyond which this source is culled when the subsystem uses a spatial index, 0 is never culled */
+	UPROPERTY(EditAnywhere, Category = DistanceBlend, meta = (ClampMin = "0", UIMin = "0", Units = "cm"))
+	float MaxRelevanceRadius = 0.f;
+
+	/** Last published weight for this source, written back by UDistanceBlendSourceProcessor */
+	UPROPERTY(Transient, VisibleAnywhere, Category = DistanceBlend)
+	float BlendWeight = 0.f;
+
+	/** Handle to this entity's slot in the subsystem, assigned on first process */
+	UPROPERTY(Transient)
+	FDistanceBlendHandle Handle;
+};
@@ -0,0 +1,61 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassProcessor.h"
+#include "MassObserverProcessor.h"
+#include "MassEntityQuery.h"
+#include "DistanceBlendSourceProcessor.generated.h"
+
+class UWorldDistanceBlendSubsystem;
+
+/**
+ * Registers entities with FDistanceBlendSourceFragment as distance blend sources, pushes their location and scalar,
+ * then reads the resulting weight back into the fragment
+ * Runs on the game thread as the subsystem is not thread-safe
+ */
+UCLASS()
+class WORLDDISTANCEBLENDMASS_API UDistanceBlendSourceProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+	UDistanceBlendSourceProcessor();
+
+	/** Subsystem the sources are registered with, the processor does nothing until this is set */
+	UPROPERTY(EditDefaultsOnly, Config, Category = DistanceBlend)
+	TSubclassOf<UWorldDistanceBlendSubsystem> SubsystemClass;
+
+	/** bDistanceXY passed to GetBlendWeights() */
+	UPROPERTY(EditDefaultsOnly, Config, Category = DistanceBlend)
+	bool bDistanceXY = true;
+
+protected:
+	virtual void ConfigureQueries() override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+	FMassEntityQuery EntityQuery;
+};
+
+/**
+ * Unregisters distance blend sources when FDistanceBlendSourceFragment is removed or the entity is destroyed
+ */
+UCLASS()
+class WORLDDISTANCEBLENDMASS_API UDistanceBlendSourceRemovalObserver : public UMassObserverProcessor
+{
+	GENERATED_BODY()
+
+public:
+	UDistanceBlendSourceRemovalObserver();
+
+	/** Must match UDistanceBlendSourceProcessor::SubsystemClass */
+	UPROPERTY(EditDefaultsOnly, Config, Category = DistanceBlend)
+	TSubclassOf<UWorldDistanceBlendSubsystem> SubsystemClass;
+
+protected:
+	virtual void ConfigureQueries() override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+	FMassEntityQuery EntityQuery;
+};
@@ -0,0 +1,519 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "DistanceBlendBenchmark.h"
+
+#include "DistanceBlendClusterTree.h"
+#include "DistanceBlendSolver.h"
+#include "DistanceBlendSpatialGrid.h"
+#include "DistanceBlendTypes.h"
+#include "WorldDistanceBlendStats.h"
+#include "Components/SceneComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+
+const FName UDistanceBlendBenchmarkSubsystem::WorldName = TEXT("DistanceBlendBenchmarkWorld");
+
+#if !UE_BUILD_SHIPPING
+namespace DistanceBlend::Benchmark
+{
+	const TCHAR* LexToString(EPattern Pattern)
+	{
+		switch (Pattern)
+		{
+		case EPattern::Static: return TEXT("Static");
+		case EPattern::Moving: return TEXT("Moving");
+		case EPattern::Streaming: return TEXT("Streaming");
+		}
+		return TEXT("Unknown");
+	}
+
+	const TCHAR* LexToString(EDistanceBlendBenchmarkPath Path)
+	{
+		switch (Path)
+		{
+		case EDistanceBlendBenchmarkPath::Reference: return TEXT("Reference");
+		case EDistanceBlendBenchmarkPath::SIMD: return TEXT("SIMD");
+		case EDistanceBlendBenchmarkPath::Parallel: return TEXT("Parallel");
+		case EDistanceBlendBenchmarkPath::Culled: return TEXT("Culled");
+		case EDistanceBlendBenchmarkPath::Nearest: return TEXT("Nearest");
+		case EDistanceBlendBenchmarkPath::Clustered: return TEXT("Clustered");
+		}
+		return TEXT("Unknown");
+	}
+
+	/** Per-component scalar loop equivalent to the original implementation, the baseline every path is compared to */
+	static void ComputeReference(FDistanceBlendPool& Pool, const FVector3f& Target, bool bDistanceXY)
+	{
+		const int32 Num = Pool.Num();
+		float TotalDistances = 0.f;
+		for (int32 i = 0; i < Num; i++)
+		{
+			const FVector3f Location { Pool.LocationX[i], Pool.LocationY[i], bDistanceXY ? Target.Z : Pool.LocationZ[i] };
+			Pool.Distances[i] = FVector3f::Dist(Target, Location);
+			TotalDistances += Pool.Distances[i];
+		}
+
+		const float AverageDistances = TotalDistances / Num;
+		float Sum = 0.f;
+		for (int32 i = 0; i < Num; i++)
+		{
+			Pool.DistanceBiases[i] = AverageDistances / Pool.Distances[i];
+			Pool.BlendWeights[i] = Pool.DistanceBiases[i] * Pool.Scalars[i];
+			Sum += Pool.BlendWeights[i];
+		}
+		for (int32 i = 0; i < Num; i++)
+		{
+			Pool.BlendWeights[i] /= Sum;
+		}
+	}
+
+	static void AddRandomSlot(FDistanceBlendPool& Pool, FDistanceBlendSpatialGrid& Grid, FRandomStream& Random, float Extent, float Radius)
+	{
+		const int32 Slot = Pool.AddSlot();
+		Pool.LocationX[Slot] = Random.FRandRange(-Extent, Extent);
+		Pool.LocationY[Slot] = Random.FRandRange(-Extent, Extent);
+		Pool.LocationZ[Slot] = Random.FRandRange(-Extent, Extent) * 0.1f;
+		Pool.Scalars[Slot] = Random.FRandRange(0.5f, 1.5f);
+		Grid.AddSlot(Slot, FVector3f(Pool.LocationX[Slot], Pool.LocationY[Slot], Pool.LocationZ[Slot]), Radius);
+	}
+
+	/** Mutate the pool between updates according to the pattern, excluded from timing */
+	static void ApplyPattern(EPattern Pattern, FDistanceBlendPool& Pool, FDistanceBlendSpatialGrid& Grid, FRandomStream& Random,
+		float Extent, float Radius)
+	{
+		const int32 Num = Pool.Num();
+		const int32 NumChanged = FMath::Max(1, Num / 10);
+		if (Pattern == EPattern::Moving)
+		{
+			for (int32 i = 0; i < NumChanged; i++)
+			{
+				const int32 Slot = Random.RandHelper(Num);
+				Pool.LocationX[Slot] += Random.FRandRange(-100.f, 100.f);
+				Pool.LocationY[Slot] += Random.FRandRange(-100.f, 100.f);
+				Grid.UpdateSlot(Slot, FVector3f(Pool.LocationX[Slot], Pool.LocationY[Slot], Pool.LocationZ[Slot]));
+			}
+		}
+		else if (Pattern == EPattern::Streaming)
+		{
+			for (int32 i = 0; i < NumChanged; i++)
+			{
+				const int32 Slot = Random.RandHelper(Pool.Num());
+				Pool.RemoveSlotAtSwap(Slot);
+				Grid.RemoveSlotAtSwap(Slot);
+			}
+			for (int32 i = 0; i < NumChanged; i++)
+			{
+				AddRandomSlot(Pool, Grid, Random, Extent, Radius);
+			}
+		}
+	}
+
+	/**
+	 * Time every solver kernel against bare synthetic pools and log the results
+	 * Usage: wdb.Benchmark [Iterations=100] [ParallelBatchSize=2048] [MaxInfluencers=8] [ClusterOpeningAngle=0.5]
+	 */
+	static void RunPool(const TArray<FString>& Args)
+	{
+		const int32 Iterations = Args.IsValidIndex(0) ? FMath::Max(1, FCString::Atoi(*Args[0])) : 100;
+		const int32 BatchSize = Args.IsValidIndex(1) ? FMath::Max(16, FCString::Atoi(*Args[1])) : 2048;
+		const int32 MaxInfluencers = Args.IsValidIndex(2) ? FMath::Max(1, FCString::Atoi(*Args[2])) : 8;
+		const float OpeningAngle = Args.IsValidIndex(3) ? FMath::Max(0.01f, FCString::Atof(*Args[3])) : 0.5f;
+
+		static constexpr int32 Counts[] = { 10, 100, 1000, 10000, 100000 };
+		static constexpr float Radius = 5000.f;
+		constexpr int32 NumPatterns = static_cast<int32>(EPattern::Streaming) + 1;
+		constexpr int32 NumPaths = static_cast<int32>(EDistanceBlendBenchmarkPath::Clustered) + 1;
+
+		UE_LOG(LogWorldDistanceBlend, Display, TEXT("wdb.Benchmark: %d iterations, batch size %d, %d influencers"), Iterations, BatchSize, MaxInfluencers);
+		UE_LOG(LogWorldDistanceBlend, Display, TEXT("%-10s %8s %-10s %12s %12s"), TEXT("Pattern"), TEXT("Count"), TEXT("Path"), TEXT("us/update"), TEXT("KiB"));
+
+		for (int32 PatternIndex = 0; PatternIndex < NumPatterns; PatternIndex++)
+		{
+			for (const int32 Num : Counts)
+			{
+				// Density is kept constant so the culled path evaluates a similar number of candidates at every count
+				const float Extent = Radius * FMath::Sqrt(static_cast<float>(Num)) * 0.5f;
+				const FVector3f Target = FVector3f::ZeroVector;
+
+				for (int32 Path = 0; Path < NumPaths; Path++)
+				{
+					FRandomStream Random(Num);
+					FDistanceBlendPool Pool;
+					FDistanceBlendPool Work;
+					FDistanceBlendSpatialGrid Grid;
+					FDistanceBlendClusterTree Tree;
+					TArray<int32> Candidates;
+					TArray<int32> Order;
+					Grid.Reset(Radius);
+					Pool.Reserve(Num);
+					for (int32 i = 0; i < Num; i++)
+					{
+						AddRandomSlot(Pool, Grid, Random, Extent, Radius);
+					}
+
+					uint64 Cycles = 0;
+					for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+					{
+						ApplyPattern(static_cast<EPattern>(PatternIndex), Pool, Grid, Random, Extent, Radius);
+						if (static_cast<EPattern>(PatternIndex) != EPattern::Static)
+						{
+							Tree.MarkDirty();
+						}
+
+						const uint64 StartCycles = FPlatformTime::Cycles64();
+						const FDistanceBlendSolver::FBatches Batches(Pool.Num(), BatchSize, Path == 2);
+						switch (Path)
+						{
+						case 0:
+							ComputeReference(Pool, Target, true);
+							break;
+						case 1:
+						case 2:
+						{
+							const float TotalDistances = FDistanceBlendSolver::ComputeDistances(Pool, Target, true, Batches);
+							FDistanceBlendSolver::ComputeWeights(Pool, TotalDistances, Batches);
+							break;
+						}
+						case 3:
+						{
+							Grid.Query(Pool, Target, true, Candidates);
+							const int32 NumCandidates = Candidates.Num();
+							if (NumCandidates > 0)
+							{
+								Work.SetNum(NumCandidates);
+								for (int32 i = 0; i < NumCandidates; i++)
+								{
+									Work.LocationX[i] = Pool.LocationX[Candidates[i]];
+									Work.LocationY[i] = Pool.LocationY[Candidates[i]];
+									Work.LocationZ[i] = Pool.LocationZ[Candidates[i]];
+									Work.Scalars[i] = Pool.Scalars[Candidates[i]];
+								}
+								const FDistanceBlendSolver::FBatches CandidateBatches(NumCandidates, BatchSize, false);
+								const float TotalDistances = FDistanceBlendSolver::ComputeDistances(Work, Target, true, CandidateBatches);
+								FDistanceBlendSolver::ComputeWeights(Work, TotalDistances, CandidateBatches);
+							}
+							break;
+						}
+						case 5:
+						{
+							// Rebuilding after the pattern moves sources is part of the cost being measured
+							Tree.Update(Pool);
+							const float TotalDistances = Tree.Gather(Pool, Target, true, OpeningAngle, Candidates, Work);
+							const FDistanceBlendSolver::FBatches EntryBatches(Candidates.Num(), BatchSize, false);
+							FDistanceBlendSolver::ComputeWeights(Work, TotalDistances, EntryBatches);
+							Tree.Scatter(Candidates, Work, Pool);
+							break;
+						}
+						default:
+							FDistanceBlendSolver::ComputeDistances(Pool, Target, true, Batches);
+							Order.SetNumUninitialized(Pool.Num(), EAllowShrinking::No);
+							FDistanceBlendSolver::ComputeNearestWeights(Pool.Scalars.GetData(), Pool.Distances.GetData(), Pool.DistanceBiases.GetData(),
+								Pool.BlendWeights.GetData(), Pool.Num(), FMath::Min(MaxInfluencers, Pool.Num()), Order);
+							break;
+						}
+						Cycles += FPlatformTime::Cycles64() - StartCycles;
+					}
+
+					const double MicrosecondsPerUpdate = FPlatformTime::ToMilliseconds64(Cycles) * 1000.0 / Iterations;
+					const SIZE_T Bytes = Pool.GetAllocatedSize() + Work.GetAllocatedSize() +
+						Candidates.GetAllocatedSize() + Order.GetAllocatedSize() + Tree.GetAllocatedSize();
+					UE_LOG(LogWorldDistanceBlend, Display, TEXT("%-10s %8d %-10s %12.2f %12.1f"), LexToString(static_cast<EPattern>(PatternIndex)), Num,
+						LexToString(static_cast<EDistanceBlendBenchmarkPath>(Path)),
+						MicrosecondsPerUpdate, Bytes / 1024.0);
+				}
+			}
+		}
+	}
+
+	FWorldHarness::FWorldHarness(const FWorldConfig& InConfig)
+		: Config(InConfig)
+		, Random(InConfig.Num)
+		, Extent(InConfig.Radius * FMath::Sqrt(static_cast<float>(FMath::Max(InConfig.Num, 1))) * 0.5f)
+	{
+		if (!GEngine)
+		{
+			return;
+		}
+
+		World = UWorld::CreateWorld(EWorldType::Game, false, UDistanceBlendBenchmarkSubsystem::WorldName);
+		FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+		WorldContext.SetCurrentWorld(World);
+
+		Subsystem = World->GetSubsystem<UDistanceBlendBenchmarkSubsystem>();
+		if (!Subsystem)
+		{
+			return;
+		}
+		Subsystem->Configure(Config.Path, Config.ParallelBatchSize, Config.MaxInfluencers, Config.ClusterOpeningAngle, Config.Radius);
+		Subsystem->AssignBlendTargetLocation(FVector::ZeroVector);
+
+		// Initial sources are registered as one batch, streaming then exercises individual registration
+		Components.Reserve(Config.Num);
+		for (int32 i = 0; i < Config.Num; i++)
+		{
+			SpawnSource();
+		}
+		Subsystem->RegisterBlendComponents(TArray<UDistanceBlendComponent*>(Components));
+	}
+
+	FWorldHarness::~FWorldHarness()
+	{
+		if (World)
+		{
+			Components.Reset();
+			GEngine->DestroyWorldContext(World);
+			World->DestroyWorld(false);
+			World = nullptr;
+			Subsystem = nullptr;
+		}
+	}
+
+	FVector FWorldHarness::RandomLocation()
+	{
+		return FVector(Random.FRandRange(-Extent, Extent), Random.FRandRange(-Extent, Extent), Random.FRandRange(-Extent, Extent) * 0.1f);
+	}
+
+	void FWorldHarness::SpawnSource()
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		AActor* Actor = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams);
+
+		USceneComponent* Root = NewObject<USceneComponent>(Actor, TEXT("Root"));
+		Root->SetMobility(EComponentMobility::Movable);
+		Actor->SetRootComponent(Root);
+		Root->RegisterComponent();
+		Actor->SetActorLocation(RandomLocation());
+
+		UDistanceBlendBenchmarkComponent* Component = NewObject<UDistanceBlendBenchmarkComponent>(Actor);
+		Component->bReceiveBlendWeight = true;
+		Component->MaxRelevanceRadius = Config.Radius;
+		Component->SetBlendScalar(Random.FRandRange(0.5f, 1.5f));
+		Component->RegisterComponent();
+		Components.Add(Component);
+	}
+
+	void FWorldHarness::DestroySource(int32 Index)
+	{
+		UDistanceBlendBenchmarkComponent* Component = Components[Index];
+		Subsystem->UnregisterBlendComponent(Component);
+		Component->GetOwner()->Destroy();
+		Components.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	}
+
+	void FWorldHarness::ApplyPattern()
+	{
+		const int32 NumChanged = FMath::Max(1, Components.Num() / 10);
+		if (Config.Pattern == EPattern::Moving)
+		{
+			// Moving the root broadcasts TransformUpdated, which is how the subsystem hears about it
+			for (int32 i = 0; i < NumChanged; i++)
+			{
+				AActor* Owner = Components[Random.RandHelper(Components.Num())]->GetOwner();
+				Owner->SetActorLocation(Owner->GetActorLocation() + FVector(Random.FRandRange(-100.f, 100.f), Random.FRandRange(-100.f, 100.f), 0.f));
+			}
+		}
+		else if (Config.Pattern == EPattern::Streaming)
+		{
+			for (int32 i = 0; i < NumChanged && Components.Num() > 0; i++)
+			{
+				DestroySource(Random.RandHelper(Components.Num()));
+			}
+			for (int32 i = 0; i < NumChanged; i++)
+			{
+				SpawnSource();
+				Subsystem->RegisterBlendComponent(Components.Last());
+			}
+		}
+	}
+
+	FUpdateStats FWorldHarness::Update()
+	{
+		FUpdateStats Stats;
+
+		Subsystem->ForceRecompute();
+
+		const SIZE_T AllocatedBefore = Subsystem->GetAllocatedSize();
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		if (Config.Path == EDistanceBlendBenchmarkPath::Reference)
+		{
+			ComputeReference(ReferenceWeights);
+		}
+		else
+		{
+			bool bValid = false;
+			Subsystem->GetBlendWeights(bValid, true);
+		}
+		Stats.Microseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) * 1000.0;
+		Stats.AllocatedSize = Subsystem->GetAllocatedSize();
+		Stats.AllocatedSizeDelta = static_cast<int64>(Stats.AllocatedSize) - static_cast<int64>(AllocatedBefore);
+		return Stats;
+	}
+
+	void FWorldHarness::ComputeReference(TArray<float>& OutWeights)
+	{
+		const int32 Num = Components.Num();
+		const float MinDistance = Subsystem->GetMinWeightingDistance();
+
+		ReferenceDistances.SetNumUninitialized(Num, EAllowShrinking::No);
+		OutWeights.SetNumZeroed(Num, EAllowShrinking::No);
+		ReferenceOrder.Reset();
+
+		// Distances are measured in 2D from the origin, matching GetBlendWeights(bValid, true)
+		for (int32 i = 0; i < Num; i++)
+		{
+			const FVector3f Location { Components[i]->GetOwner()->GetActorLocation() };
+			const float DistSquared = Location.X * Location.X + Location.Y * Location.Y;
+			ReferenceDistances[i] = FMath::Sqrt(DistSquared);
+
+			// Same relevance test as FDistanceBlendSpatialGrid::Query()
+			if (Config.Path != EDistanceBlendBenchmarkPath::Culled || DistSquared <= FMath::Square(Config.Radius))
+			{
+				ReferenceOrder.Add(i);
+			}
+		}
+
+		const int32 MaxInfluencers = Subsystem->GetMaxInfluencers();
+		if (MaxInfluencers > 0 && ReferenceOrder.Num() > MaxInfluencers)
+		{
+			ReferenceOrder.Sort([this](int32 A, int32 B)
+			{
+				return ReferenceDistances[A] < ReferenceDistances[B] || (ReferenceDistances[A] == ReferenceDistances[B] && A < B);
+			});
+			ReferenceOrder.SetNum(MaxInfluencers, EAllowShrinking::No);
+		}
+
+		if (ReferenceOrder.Num() == 0)
+		{
+			return;
+		}
+
+		float TotalDistances = 0.f;
+		for (const int32 i : ReferenceOrder)
+		{
+			TotalDistances += ReferenceDistances[i];
+		}
+
+		// Inverse distance weighting with both the average and each distance clamped to MinWeightingDistance
+		const float AverageDistances = FMath::Max(TotalDistances / ReferenceOrder.Num(), MinDistance);
+		float Sum = 0.f;
+		for (const int32 i : ReferenceOrder)
+		{
+			OutWeights[i] = AverageDistances / FMath::Max(ReferenceDistances[i], MinDistance) * Components[i]->GetBlendScalar();
+			Sum += OutWeights[i];
+		}
+		if (Sum > 0.f)
+		{
+			for (const int32 i : ReferenceOrder)
+			{
+				OutWeights[i] /= Sum;
+			}
+		}
+	}
+
+	FReferenceError FWorldHarness::CompareToReference()
+	{
+		FReferenceError Error;
+		if (Config.Path == EDistanceBlendBenchmarkPath::Reference)
+		{
+			return Error;
+		}
+
+		ComputeReference(ReferenceWeights);
+		for (int32 i = 0; i < Components.Num(); i++)
+		{
+			const float Diff = FMath::Abs(Components[i]->BlendWeight.BlendWeight - ReferenceWeights[i]);
+			Error.Max = FMath::Max(Error.Max, Diff);
+			Error.Total += Diff;
+		}
+		return Error;
+	}
+
+	/**
+	 * Time every compute path through real components registered with a subsystem in a transient world
+	 * Usage: wdb.Benchmark World [Iterations=20] [MaxCount=100000] [ParallelBatchSize=2048] [MaxInfluencers=8] [ClusterOpeningAngle=0.5]
+	 */
+	static void RunWorld(const TArray<FString>& Args)
+	{
+		const int32 Iterations = Args.IsValidIndex(0) ? FMath::Max(1, FCString::Atoi(*Args[0])) : 20;
+		const int32 MaxCount = Args.IsValidIndex(1) ? FMath::Max(1, FCString::Atoi(*Args[1])) : 100000;
+
+		FWorldConfig Config;
+		Config.ParallelBatchSize = Args.IsValidIndex(2) ? FMath::Max(16, FCString::Atoi(*Args[2])) : 2048;
+		Config.MaxInfluencers = Args.IsValidIndex(3) ? FMath::Max(1, FCString::Atoi(*Args[3])) : 8;
+		Config.ClusterOpeningAngle = Args.IsValidIndex(4) ? FMath::Max(0.01f, FCString::Atof(*Args[4])) : 0.5f;
+
+		static constexpr int32 Counts[] = { 10, 100, 1000, 10000, 100000 };
+		constexpr int32 NumPatterns = static_cast<int32>(EPattern::Streaming) + 1;
+		constexpr int32 NumPaths = static_cast<int32>(EDistanceBlendBenchmarkPath::Clustered) + 1;
+
+		UE_LOG(LogWorldDistanceBlend, Display, TEXT("wdb.Benchmark World: %d iterations, up to %d components"), Iterations, MaxCount);
+		UE_LOG(LogWorldDistanceBlend, Display, TEXT("%-10s %8s %-10s %12s %12s %14s %12s"), TEXT("Pattern"), TEXT("Count"), TEXT("Path"),
+			TEXT("us/update"), TEXT("KiB"), TEXT("Growth B/upd"), TEXT("Max error"));
+
+		for (int32 PatternIndex = 0; PatternIndex < NumPatterns; PatternIndex++)
+		{
+			for (const int32 Num : Counts)
+			{
+				if (Num > MaxCount)
+				{
+					continue;
+				}
+
+				for (int32 Path = 0; Path < NumPaths; Path++)
+				{
+					Config.Num = Num;
+					Config.Pattern = static_cast<EPattern>(PatternIndex);
+					Config.Path = static_cast<EDistanceBlendBenchmarkPath>(Path);
+
+					FWorldHarness Harness(Config);
+					if (!Harness.IsValid())
+					{
+						UE_LOG(LogWorldDistanceBlend, Warning, TEXT("wdb.Benchmark World: unable to create a benchmark world"));
+						return;
+					}
+
+					// The first update sizes every scratch buffer, steady state is what is measured
+					Harness.Update();
+
+					double Microseconds = 0.0;
+					int64 Growth = 0;
+					float MaxError = 0.f;
+					for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+					{
+						Harness.ApplyPattern();
+						const FUpdateStats Stats = Harness.Update();
+						Microseconds += Stats.Microseconds;
+						Growth += Stats.AllocatedSizeDelta;
+						MaxError = FMath::Max(MaxError, Harness.CompareToReference().Max);
+					}
+
+					UE_LOG(LogWorldDistanceBlend, Display, TEXT("%-10s %8d %-10s %12.2f %12.1f %14.1f %12.6f"), LexToString(Config.Pattern), Num,
+						LexToString(Config.Path), Microseconds / Iterations, Harness.GetSubsystem()->GetAllocatedSize() / 1024.0,
+						static_cast<double>(Growth) / Iterations, MaxError);
+				}
+			}
+		}
+	}
+
+	/** Runs headless with -ExecCmds="wdb.Benchmark" or -ExecCmds="wdb.Benchmark World" */
+	static void Run(const TArray<FString>& Args)
+	{
+		if (Args.Num() > 0 && Args[0] == TEXT("World"))
+		{
+			RunWorld(TArray<FString>(Args.GetData() + 1, Args.Num() - 1));
+			return;
+		}
+		RunPool(Args);
+	}
+}
+
+static FAutoConsoleCommand GDistanceBlendBenchmarkCommand(
+	TEXT("wdb.Benchmark"),
+	TEXT("Time every distance blend compute path against synthetic pools of 10 to 100k sources. Args: [Iterations] [ParallelBatchSize] [MaxInfluencers] [ClusterOpeningAngle]. ")
+	TEXT("Pass World first to register real components in a transient world instead. Args: World [Iterations] [MaxCount] [ParallelBatchSize] [MaxInfluencers] [ClusterOpeningAngle]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&DistanceBlend::Benchmark::Run));
+#endif
@@ -0,0 +1,108 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DistanceBlendBenchmarkTypes.h"
+#include "Math/RandomStream.h"
+
+class UWorld;
+
+#if !UE_BUILD_SHIPPING
+namespace DistanceBlend::Benchmark
+{
+	/** How sources change between updates */
+	enum class EPattern : uint8
+	{
+		Static,
+		/** A tenth of the sources move each update */
+		Moving,
+		/** A tenth of the sources are removed and as many added each update */
+		Streaming,
+	};
+
+	const TCHAR* LexToString(EPattern Pattern);
+	const TCHAR* LexToString(EDistanceBlendBenchmarkPath Path);
+
+	struct FWorldConfig
+	{
+		int32 Num = 100;
+		EDistanceBlendBenchmarkPath Path = EDistanceBlendBenchmarkPath::SIMD;
+		EPattern Pattern = EPattern::Static;
+		int32 ParallelBatchSize = 2048;
+		int32 MaxInfluencers = 8;
+		float ClusterOpeningAngle = 0.5f;
+
+		/** MaxRelevanceRadius of every source, and the spatial index cell size */
+		float Radius = 5000.f;
+	};
+
+	/** Measurements for a single update */
+	struct FUpdateStats
+	{
+		double Microseconds = 0.0;
+
+		/** Subsystem heap memory after the update, and how much it changed during it */
+		SIZE_T AllocatedSize = 0;
+		int64 AllocatedSizeDelta = 0;
+	};
+
+	/** Deviation of the weights written back to every component from the reference implementation */
+	struct FReferenceError
+	{
+		float Max = 0.f;
+		float Total = 0.f;
+	};
+
+	/**
+	 * A transient game world with Num actors, each owning a UDistanceBlendBenchmarkComponent registered with
+	 * the subsystem. Sources move through their root component and every component receives write-back, so
+	 * registration, streaming, the transform delegate and write-back are all part of what is measured
+	 */
+	class FWorldHarness
+	{
+	public:
+		explicit FWorldHarness(const FWorldConfig& InConfig);
+		~FWorldHarness();
+
+		FWorldHarness(const FWorldHarness&) = delete;
+		FWorldHarness& operator=(const FWorldHarness&) = delete;
+
+		bool IsValid() const { return Subsystem != nullptr; }
+		int32 Num() const { return Components.Num(); }
+		UDistanceBlendBenchmarkSubsystem* GetSubsystem() const { return Subsystem; }
+
+		/** Mutate the sources according to the pattern, not timed */
+		void ApplyPattern();
+
+		/** Advance a frame and fetch weights, or compute the reference weights for the Reference path */
+		FUpdateStats Update();
+
+		/** Compare the weights written back to each component against the reference for the configured path */
+		FReferenceError CompareToReference();
+
+	private:
+		void SpawnSource();
+		void DestroySource(int32 Index);
+		FVector RandomLocation();
+
+		/** Per-component scalar loop equivalent to the original implementation, over the configured path's candidates */
+		void ComputeReference(TArray<float>& OutWeights);
+
+		FWorldConfig Config;
+		FRandomStream Random;
+
+		/** Half size of the square sources are spread over, keeping density constant across counts */
+		float Extent = 0.f;
+
+		UWorld* World = nullptr;
+		UDistanceBlendBenchmarkSubsystem* Subsystem = nullptr;
+		TArray<UDistanceBlendBenchmarkComponent*> Components;
+
+		/** Scratch for the reference path */
+		TArray<float> ReferenceWeights;
+		TArray<float> ReferenceDistances;
+		TArray<int32> ReferenceOrder;
+	};
+}
+#endif
@@ -0,0 +1,83 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DistanceBlendComponent.h"
+#include "WorldDistanceBlendSubsystem.h"
+#include "DistanceBlendBenchmarkTypes.generated.h"
+
+/** Concrete component spawned by the benchmark and automation tests, registered explicitly rather than on register */
+UCLASS(NotBlueprintable, NotBlueprintType, HideDropdown)
+class UDistanceBlendBenchmarkComponent : public UDistanceBlendComponent
+{
+	GENERATED_BODY()
+
+protected:
+	virtual void OnRegister() override { UActorComponent::OnRegister(); }
+	virtual void OnUnregister() override { UActorComponent::OnUnregister(); }
+};
+
+/** Which compute path a benchmark subsystem is configured for */
+enum class EDistanceBlendBenchmarkPath : uint8
+{
+	/** Per-component scalar loop, computed outside the subsystem */
+	Reference,
+	SIMD,
+	Parallel,
+	Culled,
+	Nearest,
+	Clustered,
+};
+
+/**
+ * Subsystem only created for worlds made by the benchmark, so it never appears in real worlds
+ * Its settings are reconfigured per path instead of in the constructor
+ */
+UCLASS(NotBlueprintable, NotBlueprintType, HideDropdown)
+class UDistanceBlendBenchmarkSubsystem : public UWorldDistanceBlendSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static const FName WorldName;
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override
+	{
+		return Outer && Outer->GetFName() == WorldName;
+	}
+
+	/** Must be called before any source is registered */
+	void Configure(EDistanceBlendBenchmarkPath Path, int32 InParallelBatchSize, int32 InMaxInfluencers, float InClusterOpeningAngle,
+		float InSpatialIndexCellSize)
+	{
+		check(BlendComponents.Num() == 0);
+
+		bUseSpatialIndex = Path == EDistanceBlendBenchmarkPath::Culled;
+		SpatialIndexCellSize = InSpatialIndexCellSize;
+		SpatialGrid.Reset(SpatialIndexCellSize);
+		MaxInfluencers = Path == EDistanceBlendBenchmarkPath::Nearest ? InMaxInfluencers : 0;
+		ClusterOpeningAngle = Path == EDistanceBlendBenchmarkPath::Clustered ? InClusterOpeningAngle : 0.f;
+		ParallelThreshold = Path == EDistanceBlendBenchmarkPath::Parallel ? 1 : 0;
+		ParallelBatchSize = InParallelBatchSize;
+	}
+
+	/**
+	 * Nothing ticks the engine between benchmark updates, so forget which frame was last computed so that the next
+	 * update is allowed to compute again, without advancing GFrameCounter for every other system
+	 */
+	void ForceRecompute()
+	{
+		LastUpdateFrame = -1;
+		LastInterpolatedFrame = -1;
+		TargetsLastUpdateFrame = -1;
+		bPrecomputeReused = false;
+		for (TPair<FName, FDistanceBlendChannel>& Channel : BlendChannels)
+		{
+			Channel.Value.LastUpdateFrame = -1;
+		}
+	}
+
+	float GetMinWeightingDistance() const { return MinWeightingDistance; }
+	int32 GetMaxInfluencers() const { return MaxInfluencers; }
+};
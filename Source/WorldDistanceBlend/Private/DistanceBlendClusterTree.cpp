@@ -0,0 +1,189 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "DistanceBlendClusterTree.h"
+
+#include "DistanceBlendTypes.h"
+#include <algorithm>
+
+void FDistanceBlendClusterTree::Update(const FDistanceBlendPool& Pool)
+{
+	if (bDirty || Order.Num() != Pool.Num())
+	{
+		Build(Pool);
+	}
+	else if (bScalarsDirty)
+	{
+		RefitScalars(Pool);
+	}
+}
+
+void FDistanceBlendClusterTree::Build(const FDistanceBlendPool& Pool)
+{
+	const int32 Num = Pool.Num();
+
+	Nodes.Reset();
+	Order.SetNumUninitialized(Num, EAllowShrinking::No);
+	for (int32 i = 0; i < Num; i++)
+	{
+		Order[i] = i;
+	}
+
+	if (Num > 0)
+	{
+		Nodes.Reserve(2 * FMath::DivideAndRoundUp(Num, LeafSize));
+		Nodes.AddUninitialized();
+		BuildNode(Pool, 0, 0, Num);
+	}
+
+	bDirty = false;
+	bScalarsDirty = false;
+}
+
+void FDistanceBlendClusterTree::BuildNode(const FDistanceBlendPool& Pool, int32 NodeIndex, int32 Begin, int32 Num)
+{
+	FBox3f Bounds(ForceInit);
+	FVector3f Sum = FVector3f::ZeroVector;
+	float ScalarSum = 0.f;
+	for (int32 i = Begin; i < Begin + Num; i++)
+	{
+		const int32 Slot = Order[i];
+		const FVector3f Location { Pool.LocationX[Slot], Pool.LocationY[Slot], Pool.LocationZ[Slot] };
+		Bounds += Location;
+		Sum += Location;
+		ScalarSum += Pool.Scalars[Slot];
+	}
+
+	const FVector3f Extent = Bounds.GetSize();
+	const float Size = Extent.GetMax();
+	{
+		FNode& Node = Nodes[NodeIndex];
+		Node.Center = Sum / Num;
+		Node.Size = Size;
+		Node.ScalarSum = ScalarSum;
+		Node.Begin = Begin;
+		Node.Num = Num;
+		Node.FirstChild = INDEX_NONE;
+	}
+
+	// Coincident members can never be separated, keep them as a leaf
+	if (Num <= LeafSize || Size <= 0.f)
+	{
+		return;
+	}
+
+	// Median split along the longest axis keeps the tree balanced regardless of distribution
+	const int32 Axis = Extent.X >= Extent.Y && Extent.X >= Extent.Z ? 0 : Extent.Y >= Extent.Z ? 1 : 2;
+	const float* Locations = Axis == 0 ? Pool.LocationX.GetData() : Axis == 1 ? Pool.LocationY.GetData() : Pool.LocationZ.GetData();
+	const int32 Mid = Num / 2;
+	std::nth_element(Order.GetData() + Begin, Order.GetData() + Begin + Mid, Order.GetData() + Begin + Num,
+		[Locations](int32 A, int32 B) { return Locations[A] < Locations[B]; });
+
+	// Nodes may reallocate while building children, only hold indices across recursion
+	const int32 FirstChild = Nodes.AddUninitialized(2);
+	Nodes[NodeIndex].FirstChild = FirstChild;
+	BuildNode(Pool, FirstChild, Begin, Mid);
+	BuildNode(Pool, FirstChild + 1, Begin + Mid, Num - Mid);
+}
+
+void FDistanceBlendClusterTree::RefitScalars(const FDistanceBlendPool& Pool)
+{
+	for (int32 NodeIndex = Nodes.Num() - 1; NodeIndex >= 0; NodeIndex--)
+	{
+		FNode& Node = Nodes[NodeIndex];
+		if (Node.FirstChild != INDEX_NONE)
+		{
+			Node.ScalarSum = Nodes[Node.FirstChild].ScalarSum + Nodes[Node.FirstChild + 1].ScalarSum;
+		}
+		else
+		{
+			Node.ScalarSum = 0.f;
+			for (int32 i = Node.Begin; i < Node.Begin + Node.Num; i++)
+			{
+				Node.ScalarSum += Pool.Scalars[Order[i]];
+			}
+		}
+	}
+	bScalarsDirty = false;
+}
+
+float FDistanceBlendClusterTree::Gather(const FDistanceBlendPool& Pool, const FVector3f& Target, bool bDistanceXY,
+	float OpeningAngle, TArray<int32>& OutEntries, FDistanceBlendPool& Work) const
+{
+	OutEntries.Reset();
+	Work.SetNum(0);
+	if (Nodes.IsEmpty())
+	{
+		return 0.f;
+	}
+
+	auto Distance = [&Target, bDistanceXY](const FVector3f& Location)
+	{
+		return bDistanceXY ? FVector3f::DistXY(Target, Location) : FVector3f::Dist(Target, Location);
+	};
+
+	// Distances are accumulated per source rather than per entry, a cluster counts once for each member
+	float TotalSourceDistances = 0.f;
+
+	TArray<int32, TInlineAllocator<64>> Stack;
+	Stack.Add(0);
+	while (!Stack.IsEmpty())
+	{
+		const FNode& Node = Nodes[Stack.Pop(EAllowShrinking::No)];
+		const float NodeDistance = Distance(Node.Center);
+		if (Node.Size < OpeningAngle * NodeDistance)
+		{
+			const int32 Entry = Work.AddSlot();
+			Work.Distances[Entry] = NodeDistance;
+			Work.Scalars[Entry] = Node.ScalarSum;
+			OutEntries.Add(-(static_cast<int32>(&Node - Nodes.GetData()) + 1));
+			TotalSourceDistances += NodeDistance * Node.Num;
+		}
+		else if (Node.FirstChild == INDEX_NONE)
+		{
+			for (int32 i = Node.Begin; i < Node.Begin + Node.Num; i++)
+			{
+				const int32 Slot = Order[i];
+				const int32 Entry = Work.AddSlot();
+				Work.Distances[Entry] = Distance(FVector3f(Pool.LocationX[Slot], Pool.LocationY[Slot], Pool.LocationZ[Slot]));
+				Work.Scalars[Entry] = Pool.Scalars[Slot];
+				OutEntries.Add(Slot);
+				TotalSourceDistances += Work.Distances[Entry];
+			}
+		}
+		else
+		{
+			Stack.Add(Node.FirstChild);
+			Stack.Add(Node.FirstChild + 1);
+		}
+	}
+
+	// The solver averages over entries, scale so that matches the average over every source
+	return TotalSourceDistances / Order.Num() * OutEntries.Num();
+}
+
+void FDistanceBlendClusterTree::Scatter(TConstArrayView<int32> Entries, const FDistanceBlendPool& Work, FDistanceBlendPool& Pool) const
+{
+	for (int32 Entry = 0; Entry < Entries.Num(); Entry++)
+	{
+		const int32 Index = Entries[Entry];
+		if (Index >= 0)
+		{
+			Pool.Distances[Index] = Work.Distances[Entry];
+			Pool.DistanceBiases[Index] = Work.DistanceBiases[Entry];
+			Pool.BlendWeights[Index] = Work.BlendWeights[Entry];
+			continue;
+		}
+
+		// Every member shares the cluster's distance and bias, its weight is split by scalar
+		const FNode& Node = Nodes[-Index - 1];
+		const float WeightPerScalar = Node.ScalarSum > 0.f ? Work.BlendWeights[Entry] / Node.ScalarSum : 0.f;
+		for (int32 i = Node.Begin; i < Node.Begin + Node.Num; i++)
+		{
+			const int32 Slot = Order[i];
+			Pool.Distances[Slot] = Work.Distances[Entry];
+			Pool.DistanceBiases[Slot] = Work.DistanceBiases[Entry];
+			Pool.BlendWeights[Slot] = Pool.Scalars[Slot] * WeightPerScalar;
+		}
+	}
+}
@@ -3,7 +3,27 @@
 
 #include "DistanceBlendComponent.h"
 
+#include "WorldDistanceBlendSubsystem.h"
+
+void UDistanceBlendComponent::SetBlendScalar(float NewBlendScalar)
+{
+	BlendScalar = NewBlendScalar;
+	if (UWorldDistanceBlendSubsystem* Subsystem = BlendSubsystem.Get())
+	{
+		Subsystem->SetBlendComponentScalar(this, NewBlendScalar);
+	}
+}
+
+FDistanceBlendWeight UDistanceBlendComponent::GetLatestBlendWeight() const
+{
+	if (const UWorldDistanceBlendSubsystem* Subsystem = BlendSubsystem.Get())
+	{
+		return Subsystem->GetBlendComponentWeight(this);
+	}
+	return FDistanceBlendWeight();
+}
+
 float UDistanceBlendComponent::GetBlendScalar_Implementation() const
 {
-	return 1.f;
+	return BlendScalar;
 }
@@ -0,0 +1,206 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "DistanceBlendReplicator.h"
+
+#include "DistanceBlendComponent.h"
+#include "WorldDistanceBlendStats.h"
+#include "WorldDistanceBlendSubsystem.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Net/UnrealNetwork.h"
+
+bool FDistanceBlendReplicatedWeight::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	UObject* Object = Component;
+	bOutSuccess = Map->SerializeObject(Ar, UDistanceBlendComponent::StaticClass(), Object);
+	if (Ar.IsLoading())
+	{
+		Component = Cast<UDistanceBlendComponent>(Object);
+	}
+
+	SerializeWeight(Ar, Weight);
+	return true;
+}
+
+ADistanceBlendReplicator::ADistanceBlendReplicator(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = true;
+	PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+	PrimaryActorTick.TickInterval = 0.1f;
+
+	bReplicates = true;
+	bOnlyRelevantToOwner = true;
+	bAlwaysRelevant = false;
+	SetReplicatingMovement(false);
+}
+
+void ADistanceBlendReplicator::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME_CONDITION(ThisClass, SubsystemClass, COND_InitialOnly);
+	DOREPLIFETIME(ThisClass, ReplicatedWeights);
+}
+
+void ADistanceBlendReplicator::InitializeReplicator(UWorldDistanceBlendSubsystem* Subsystem, APlayerController* PlayerController)
+{
+	check(HasAuthority() && Subsystem && PlayerController);
+
+	SubsystemClass = Subsystem->GetClass();
+	SetOwner(PlayerController);
+
+	// The server receives each client's camera location, which is also where that client listens from
+	TargetHandle = Subsystem->AddBlendTarget(PlayerController->PlayerCameraManager);
+}
+
+void ADistanceBlendReplicator::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UWorldDistanceBlendSubsystem* Subsystem = GetSubsystem())
+	{
+		if (HasAuthority())
+		{
+			Subsystem->RemoveBlendTarget(TargetHandle);
+		}
+		else
+		{
+			Subsystem->ApplyReplicatedBlendWeights({});
+		}
+	}
+	TargetHandle = {};
+
+	Super::EndPlay(EndPlayReason);
+}
+
+UWorldDistanceBlendSubsystem* ADistanceBlendReplicator::GetSubsystem() const
+{
+	const UWorld* World = GetWorld();
+	return World && SubsystemClass ? Cast<UWorldDistanceBlendSubsystem>(World->GetSubsystemBase(SubsystemClass)) : nullptr;
+}
+
+float ADistanceBlendReplicator::GetReplicatedBlendWeight(const UDistanceBlendComponent* BlendComponent) const
+{
+	for (const FDistanceBlendReplicatedWeight& Item : ReplicatedWeights.Items)
+	{
+		if (Item.Component == BlendComponent)
+		{
+			return Item.GetBlendWeight();
+		}
+	}
+	return 0.f;
+}
+
+void ADistanceBlendReplicator::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (!HasAuthority())
+	{
+		// Clients only apply what they receive
+		SetActorTickEnabled(false);
+		return;
+	}
+
+	if (UWorldDistanceBlendSubsystem* Subsystem = GetSubsystem())
+	{
+		UpdateReplicatedWeights(Subsystem);
+	}
+}
+
+void ADistanceBlendReplicator::UpdateReplicatedWeights(UWorldDistanceBlendSubsystem* Subsystem)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(ADistanceBlendReplicator::UpdateReplicatedWeights, WorldDistanceBlendChannel);
+
+	bool bValid = false;
+	const TArray<FDistanceBlendWeight>& Weights = Subsystem->GetBlendWeightsForTarget(TargetHandle, bValid, bDistanceXY);
+
+	// Keep the strongest slots in descending order, MaxReplicatedWeights is small so insertion beats a full sort
+	const int32 K = FMath::Max(MaxReplicatedWeights, 1);
+	StrongestSlots.Reset();
+	if (bValid)
+	{
+		for (const FDistanceBlendWeight& Weight : Weights)
+		{
+			if (Weight.BlendWeight <= 0.f || !Subsystem->GetBlendWeightComponent(Weight))
+			{
+				continue;
+			}
+			if (StrongestSlots.Num() == K && Weight.BlendWeight <= Weights[StrongestSlots.Last()].BlendWeight)
+			{
+				continue;
+			}
+
+			int32 Insert = StrongestSlots.Num();
+			while (Insert > 0 && Weights[StrongestSlots[Insert - 1]].BlendWeight < Weight.BlendWeight)
+			{
+				Insert--;
+			}
+			StrongestSlots.Insert(Weight.Slot, Insert);
+			if (StrongestSlots.Num() > K)
+			{
+				StrongestSlots.Pop(EAllowShrinking::No);
+			}
+		}
+	}
+
+	TArray<FDistanceBlendReplicatedWeight>& Items = ReplicatedWeights.Items;
+
+	// Drop components that are no longer among the strongest, or quantize to nothing
+	bool bRemoved = false;
+	for (int32 Index = Items.Num() - 1; Index >= 0; Index--)
+	{
+		const bool bKeep = StrongestSlots.ContainsByPredicate([&](int32 Slot)
+		{
+			return Subsystem->GetBlendWeightComponent(Weights[Slot]) == Items[Index].Component &&
+				FDistanceBlendReplicatedWeight::Quantize(Weights[Slot].BlendWeight, Precision) > 0;
+		});
+		if (!bKeep)
+		{
+			Items.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+			bRemoved = true;
+		}
+	}
+	if (bRemoved)
+	{
+		ReplicatedWeights.MarkArrayDirty();
+	}
+
+	// Only items whose quantized weight changed are dirtied, so steady weights cost nothing to replicate
+	for (const int32 Slot : StrongestSlots)
+	{
+		const uint16 Quantized = FDistanceBlendReplicatedWeight::Quantize(Weights[Slot].BlendWeight, Precision);
+		if (Quantized == 0)
+		{
+			continue;
+		}
+
+		UDistanceBlendComponent* Component = Subsystem->GetBlendWeightComponent(Weights[Slot]);
+		FDistanceBlendReplicatedWeight* Item = Items.FindByPredicate([Component](const FDistanceBlendReplicatedWeight& Existing)
+		{
+			return Existing.Component == Component;
+		});
+		if (!Item)
+		{
+			Item = &Items.AddDefaulted_GetRef();
+			Item->Component = Component;
+		}
+		else if (Item->Weight == Quantized)
+		{
+			continue;
+		}
+
+		Item->Weight = Quantized;
+		ReplicatedWeights.MarkItemDirty(*Item);
+	}
+}
+
+void ADistanceBlendReplicator::OnRep_ReplicatedWeights()
+{
+	if (UWorldDistanceBlendSubsystem* Subsystem = GetSubsystem())
+	{
+		Subsystem->ApplyReplicatedBlendWeights(ReplicatedWeights.Items);
+	}
+}
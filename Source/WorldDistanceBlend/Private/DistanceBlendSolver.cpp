@@ -0,0 +1,351 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "DistanceBlendSolver.h"
+
+#include "DistanceBlendTypes.h"
+#include "WorldDistanceBlendStats.h"
+#include "Algo/Sort.h"
+#include <algorithm>
+
+FORCEINLINE float FDistanceBlendSolver::HorizontalSum(const VectorRegister4Float& V)
+{
+	alignas(16) float Lanes[VectorWidth];
+	VectorStoreAligned(V, Lanes);
+	return (Lanes[0] + Lanes[1]) + (Lanes[2] + Lanes[3]);
+}
+
+template<typename FuncType>
+FORCEINLINE float FDistanceBlendSolver::VisitWeighting(const FWeighting& Weighting, float AverageDistances, FuncType&& Fn)
+{
+	switch (Weighting.Policy)
+	{
+	case EDistanceBlendWeighting::InverseSquare:
+		return Fn(FInverseSquare(AverageDistances, Weighting));
+	case EDistanceBlendWeighting::RadiusFalloff:
+		return Fn(FRadiusFalloff(AverageDistances, Weighting));
+	case EDistanceBlendWeighting::Curve:
+		if (Weighting.Curve && Weighting.Curve->IsValid())
+		{
+			return Fn(FCurve(AverageDistances, Weighting));
+		}
+		[[fallthrough]];
+	case EDistanceBlendWeighting::InverseDistance:
+	default:
+		return Fn(FInverseDistance(AverageDistances, Weighting));
+	}
+}
+
+bool FDistanceBlendSolver::Solve(const FInput& In, const FVector3f& Target, bool bDistanceXY, const FOutput& Out,
+	const FWeighting& Weighting)
+{
+	const int32 Num = In.Num();
+	check(In.LocationX.Num() == Num && In.LocationY.Num() == Num && In.LocationZ.Num() == Num);
+	check(Out.Distances.Num() == Num && Out.DistanceBiases.Num() == Num && Out.BlendWeights.Num() == Num);
+	if (Num == 0)
+	{
+		return false;
+	}
+
+	const float TotalDistances = ComputeDistances(In.LocationX.GetData(), In.LocationY.GetData(), In.LocationZ.GetData(), Target,
+		bDistanceXY, Out.Distances.GetData(), 0, Num);
+	ComputeWeights(In.Scalars.GetData(), Out.Distances.GetData(), Out.DistanceBiases.GetData(), Out.BlendWeights.GetData(), Num,
+		TotalDistances, FBatches(Num, Num, false), Weighting);
+	return true;
+}
+
+bool FDistanceBlendSolver::SolveNearest(const FInput& In, const FVector3f& Target, bool bDistanceXY, int32 MaxInfluencers,
+	TArrayView<int32> OrderScratch, const FOutput& Out, const FWeighting& Weighting)
+{
+	const int32 Num = In.Num();
+	check(In.LocationX.Num() == Num && In.LocationY.Num() == Num && In.LocationZ.Num() == Num);
+	check(Out.Distances.Num() == Num && Out.DistanceBiases.Num() == Num && Out.BlendWeights.Num() == Num);
+	if (Num == 0)
+	{
+		return false;
+	}
+
+	ComputeDistances(In.LocationX.GetData(), In.LocationY.GetData(), In.LocationZ.GetData(), Target, bDistanceXY,
+		Out.Distances.GetData(), 0, Num);
+	ComputeNearestWeights(In.Scalars.GetData(), Out.Distances.GetData(), Out.DistanceBiases.GetData(), Out.BlendWeights.GetData(),
+		Num, FMath::Clamp(MaxInfluencers, 1, Num), OrderScratch, Weighting);
+	return true;
+}
+
+float FDistanceBlendSolver::ComputeDistances(const float* RESTRICT LocX, const float* RESTRICT LocY, const float* RESTRICT LocZ,
+	const FVector3f& Target, bool bDistanceXY, float* RESTRICT Distances, int32 Begin, int32 End)
+{
+	const int32 VectorEnd = End - ((End - Begin) % VectorWidth);
+
+	const VectorRegister4Float TX = VectorSetFloat1(Target.X);
+	const VectorRegister4Float TY = VectorSetFloat1(Target.Y);
+	const VectorRegister4Float TZ = VectorSetFloat1(Target.Z);
+	VectorRegister4Float Total = VectorZeroFloat();
+
+	for (int32 i = Begin; i < VectorEnd; i += VectorWidth)
+	{
+		const VectorRegister4Float DX = VectorSubtract(TX, VectorLoad(LocX + i));
+		const VectorRegister4Float DY = VectorSubtract(TY, VectorLoad(LocY + i));
+		VectorRegister4Float DistSq = VectorMultiplyAdd(DX, DX, VectorMultiply(DY, DY));
+		if (!bDistanceXY)
+		{
+			const VectorRegister4Float DZ = VectorSubtract(TZ, VectorLoad(LocZ + i));
+			DistSq = VectorMultiplyAdd(DZ, DZ, DistSq);
+		}
+		const VectorRegister4Float Dist = VectorSqrt(DistSq);
+		VectorStore(Dist, Distances + i);
+		Total = VectorAdd(Total, Dist);
+	}
+
+	float TotalDistances = HorizontalSum(Total);
+	for (int32 i = VectorEnd; i < End; i++)
+	{
+		const float DX = Target.X - LocX[i];
+		const float DY = Target.Y - LocY[i];
+		const float DZ = bDistanceXY ? 0.f : Target.Z - LocZ[i];
+		Distances[i] = FMath::Sqrt(DX * DX + DY * DY + DZ * DZ);
+		TotalDistances += Distances[i];
+	}
+	return TotalDistances;
+}
+
+void FDistanceBlendSolver::ComputeDistanceMatrix(const FDistanceBlendPool& Pool, TConstArrayView<FVector3f> Targets, bool bDistanceXY,
+	float* const* OutDistances, float* OutTotals, int32 Begin, int32 End)
+{
+	const int32 VectorEnd = End - ((End - Begin) % VectorWidth);
+	const int32 NumTargets = Targets.Num();
+
+	const float* RESTRICT LocX = Pool.LocationX.GetData();
+	const float* RESTRICT LocY = Pool.LocationY.GetData();
+	const float* RESTRICT LocZ = Pool.LocationZ.GetData();
+
+	TArray<VectorRegister4Float, TInlineAllocator<8>> Totals;
+	TArray<VectorRegister4Float, TInlineAllocator<8>> TX, TY, TZ;
+	Totals.Init(VectorZeroFloat(), NumTargets);
+	for (const FVector3f& Target : Targets)
+	{
+		TX.Add(VectorSetFloat1(Target.X));
+		TY.Add(VectorSetFloat1(Target.Y));
+		TZ.Add(VectorSetFloat1(Target.Z));
+	}
+
+	for (int32 i = Begin; i < VectorEnd; i += VectorWidth)
+	{
+		const VectorRegister4Float X = VectorLoad(LocX + i);
+		const VectorRegister4Float Y = VectorLoad(LocY + i);
+		const VectorRegister4Float Z = VectorLoad(LocZ + i);
+		for (int32 T = 0; T < NumTargets; T++)
+		{
+			const VectorRegister4Float DX = VectorSubtract(TX[T], X);
+			const VectorRegister4Float DY = VectorSubtract(TY[T], Y);
+			VectorRegister4Float DistSq = VectorMultiplyAdd(DX, DX, VectorMultiply(DY, DY));
+			if (!bDistanceXY)
+			{
+				const VectorRegister4Float DZ = VectorSubtract(TZ[T], Z);
+				DistSq = VectorMultiplyAdd(DZ, DZ, DistSq);
+			}
+			const VectorRegister4Float Dist = VectorSqrt(DistSq);
+			VectorStore(Dist, OutDistances[T] + i);
+			Totals[T] = VectorAdd(Totals[T], Dist);
+		}
+	}
+
+	for (int32 T = 0; T < NumTargets; T++)
+	{
+		const FVector3f& Target = Targets[T];
+		float* RESTRICT Distances = OutDistances[T];
+		float TotalDistances = HorizontalSum(Totals[T]);
+		for (int32 i = VectorEnd; i < End; i++)
+		{
+			const float DX = Target.X - LocX[i];
+			const float DY = Target.Y - LocY[i];
+			const float DZ = bDistanceXY ? 0.f : Target.Z - LocZ[i];
+			Distances[i] = FMath::Sqrt(DX * DX + DY * DY + DZ * DZ);
+			TotalDistances += Distances[i];
+		}
+		OutTotals[T] = TotalDistances;
+	}
+}
+
+template<typename PolicyType>
+float FDistanceBlendSolver::ComputeBiasedWeights(const PolicyType& Policy, const float* RESTRICT Scalars, const float* RESTRICT Distances,
+	float* RESTRICT Biases, float* RESTRICT Weights, int32 Begin, int32 End)
+{
+	const int32 VectorEnd = End - ((End - Begin) % VectorWidth);
+
+	VectorRegister4Float Total = VectorZeroFloat();
+
+	for (int32 i = Begin; i < VectorEnd; i += VectorWidth)
+	{
+		const VectorRegister4Float Bias = Policy(VectorLoad(Distances + i));
+		const VectorRegister4Float Weight = VectorMultiply(Bias, VectorLoad(Scalars + i));
+		VectorStore(Bias, Biases + i);
+		VectorStore(Weight, Weights + i);
+		Total = VectorAdd(Total, Weight);
+	}
+
+	float Sum = HorizontalSum(Total);
+	for (int32 i = VectorEnd; i < End; i++)
+	{
+		Biases[i] = Policy(Distances[i]);
+		Weights[i] = Biases[i] * Scalars[i];
+		Sum += Weights[i];
+	}
+	return Sum;
+}
+
+template float FDistanceBlendSolver::ComputeBiasedWeights<FDistanceBlendSolver::FInverseDistance>(
+	const FInverseDistance&, const float*, const float*, float*, float*, int32, int32);
+template float FDistanceBlendSolver::ComputeBiasedWeights<FDistanceBlendSolver::FInverseSquare>(
+	const FInverseSquare&, const float*, const float*, float*, float*, int32, int32);
+template float FDistanceBlendSolver::ComputeBiasedWeights<FDistanceBlendSolver::FRadiusFalloff>(
+	const FRadiusFalloff&, const float*, const float*, float*, float*, int32, int32);
+template float FDistanceBlendSolver::ComputeBiasedWeights<FDistanceBlendSolver::FCurve>(
+	const FCurve&, const float*, const float*, float*, float*, int32, int32);
+
+void FDistanceBlendSolver::NormalizeWeights(float* RESTRICT Weights, float Sum, int32 Begin, int32 End)
+{
+	const int32 VectorEnd = End - ((End - Begin) % VectorWidth);
+
+	const VectorRegister4Float Total = VectorSetFloat1(Sum);
+	for (int32 i = Begin; i < VectorEnd; i += VectorWidth)
+	{
+		VectorStore(VectorDivide(VectorLoad(Weights + i), Total), Weights + i);
+	}
+	for (int32 i = VectorEnd; i < End; i++)
+	{
+		Weights[i] /= Sum;
+	}
+}
+
+float FDistanceBlendSolver::ComputeDistances(FDistanceBlendPool& Pool, const FVector3f& Target, bool bDistanceXY, const FBatches& Batches)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(FDistanceBlendSolver::ComputeDistances, WorldDistanceBlendChannel);
+	SCOPE_CYCLE_COUNTER(STAT_WorldDistanceBlend_GatherDistances);
+
+	return Batches.Sum([&](int32 Begin, int32 End)
+	{
+		return ComputeDistances(Pool, Target, bDistanceXY, Begin, End);
+	});
+}
+
+void FDistanceBlendSolver::ComputeDistanceMatrix(const FDistanceBlendPool& Pool, TConstArrayView<FVector3f> Targets, bool bDistanceXY,
+	float* const* OutDistances, float* OutTotals, const FBatches& Batches)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(FDistanceBlendSolver::ComputeDistanceMatrix, WorldDistanceBlendChannel);
+	SCOPE_CYCLE_COUNTER(STAT_WorldDistanceBlend_GatherDistances);
+
+	const int32 NumTargets = Targets.Num();
+
+	TArray<float, TInlineAllocator<64>> Partials;
+	Partials.SetNumUninitialized(Batches.NumBatches * NumTargets);
+	Batches.ForEach([&](int32 Batch, int32 Begin, int32 End)
+	{
+		ComputeDistanceMatrix(Pool, Targets, bDistanceXY, OutDistances, Partials.GetData() + Batch * NumTargets, Begin, End);
+	});
+
+	for (int32 T = 0; T < NumTargets; T++)
+	{
+		OutTotals[T] = 0.f;
+		for (int32 Batch = 0; Batch < Batches.NumBatches; Batch++)
+		{
+			OutTotals[T] += Partials[Batch * NumTargets + T];
+		}
+	}
+}
+
+float FDistanceBlendSolver::ComputeWeights(const float* Scalars, const float* Distances, float* Biases, float* Weights, int32 Num,
+	float TotalDistances, const FBatches& Batches, const FWeighting& Weighting)
+{
+	const float AverageDistances = TotalDistances / Num;
+	float Sum;
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(FDistanceBlendSolver::BiasWeights, WorldDistanceBlendChannel);
+		SCOPE_CYCLE_COUNTER(STAT_WorldDistanceBlend_BiasWeights);
+		Sum = VisitWeighting(Weighting, AverageDistances, [&](const auto& Policy)
+		{
+			return Batches.Sum([&](int32 Begin, int32 End)
+			{
+				return ComputeBiasedWeights(Policy, Scalars, Distances, Biases, Weights, Begin, End);
+			});
+		});
+	}
+
+	// Every source can be beyond the falloff radius, leave them all at zero rather than dividing by it
+	if (Sum <= 0.f)
+	{
+		return Sum;
+	}
+
+	// Scale array to become 1.0
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(FDistanceBlendSolver::NormalizeWeights, WorldDistanceBlendChannel);
+		SCOPE_CYCLE_COUNTER(STAT_WorldDistanceBlend_NormalizeWeights);
+		Batches.ForEach([&](int32, int32 Begin, int32 End)
+		{
+			NormalizeWeights(Weights, Sum, Begin, End);
+		});
+	}
+	return Sum;
+}
+
+float FDistanceBlendSolver::ComputeWeights(FDistanceBlendPool& Pool, float TotalDistances, const FBatches& Batches,
+	const FWeighting& Weighting)
+{
+	return ComputeWeights(Pool.Scalars.GetData(), Pool.Distances.GetData(), Pool.DistanceBiases.GetData(),
+		Pool.BlendWeights.GetData(), Pool.Num(), TotalDistances, Batches, Weighting);
+}
+
+void FDistanceBlendSolver::SelectNearest(TArrayView<int32> Indices, const float* Distances, int32 K)
+{
+	auto Nearer = [Distances](int32 A, int32 B)
+	{
+		return Distances[A] < Distances[B] || (Distances[A] == Distances[B] && A < B);
+	};
+	std::nth_element(Indices.GetData(), Indices.GetData() + K - 1, Indices.GetData() + Indices.Num(), Nearer);
+	Algo::Sort(MakeArrayView(Indices.GetData(), K));
+}
+
+void FDistanceBlendSolver::ComputeNearestWeights(const float* Scalars, const float* Distances, float* Biases, float* Weights,
+	int32 Num, int32 MaxInfluencers, TArrayView<int32> Order, const FWeighting& Weighting)
+{
+	check(Order.Num() >= Num && MaxInfluencers > 0 && MaxInfluencers <= Num);
+
+	TArrayView<int32> Indices = Order.Left(Num);
+	for (int32 i = 0; i < Num; i++)
+	{
+		Indices[i] = i;
+		Biases[i] = 0.f;
+		Weights[i] = 0.f;
+	}
+	SelectNearest(Indices, Distances, MaxInfluencers);
+
+	// Few entries are selected, so they are weighted in place rather than gathered for the vector kernels
+	float TotalDistances = 0.f;
+	for (int32 i = 0; i < MaxInfluencers; i++)
+	{
+		TotalDistances += Distances[Indices[i]];
+	}
+
+	const float Sum = VisitWeighting(Weighting, TotalDistances / MaxInfluencers, [&](const auto& Policy)
+	{
+		float Total = 0.f;
+		for (int32 i = 0; i < MaxInfluencers; i++)
+		{
+			const int32 Slot = Indices[i];
+			Biases[Slot] = Policy(Distances[Slot]);
+			Weights[Slot] = Biases[Slot] * Scalars[Slot];
+			Total += Weights[Slot];
+		}
+		return Total;
+	});
+
+	if (Sum <= 0.f)
+	{
+		return;
+	}
+	for (int32 i = 0; i < MaxInfluencers; i++)
+	{
+		Weights[Indices[i]] /= Sum;
+	}
+}
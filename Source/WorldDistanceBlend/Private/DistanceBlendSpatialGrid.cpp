@@ -0,0 +1,146 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "DistanceBlendSpatialGrid.h"
+
+#include "DistanceBlendTypes.h"
+
+void FDistanceBlendSpatialGrid::Reset(float InCellSize)
+{
+	CellSize = FMath::Max(InCellSize, 1.f);
+	MaxRadius = 0.f;
+	Cells.Reset();
+	Unbounded.Reset();
+	SlotCells.Reset();
+	SlotBucketIndices.Reset();
+	SlotRadii.Reset();
+}
+
+void FDistanceBlendSpatialGrid::Reserve(int32 Capacity)
+{
+	SlotCells.Reserve(Capacity);
+	SlotBucketIndices.Reserve(Capacity);
+	SlotRadii.Reserve(Capacity);
+}
+
+SIZE_T FDistanceBlendSpatialGrid::GetAllocatedSize() const
+{
+	SIZE_T Size = Cells.GetAllocatedSize() + Unbounded.GetAllocatedSize() + SlotCells.GetAllocatedSize() +
+		SlotBucketIndices.GetAllocatedSize() + SlotRadii.GetAllocatedSize();
+	for (const TPair<FIntPoint, TArray<int32>>& Cell : Cells)
+	{
+		Size += Cell.Value.GetAllocatedSize();
+	}
+	return Size;
+}
+
+void FDistanceBlendSpatialGrid::AddSlot(int32 Slot, const FVector3f& Location, float Radius)
+{
+	check(Slot == SlotRadii.Num());
+
+	SlotCells.Add(GetCell(Location));
+	SlotBucketIndices.Add(INDEX_NONE);
+	SlotRadii.Add(Radius);
+	MaxRadius = FMath::Max(MaxRadius, Radius);
+
+	AddToBucket(Slot);
+}
+
+void FDistanceBlendSpatialGrid::UpdateSlot(int32 Slot, const FVector3f& Location)
+{
+	const FIntPoint Cell = GetCell(Location);
+	if (SlotRadii[Slot] > 0.f && Cell != SlotCells[Slot])
+	{
+		RemoveFromBucket(Slot);
+		SlotCells[Slot] = Cell;
+		AddToBucket(Slot);
+	}
+}
+
+void FDistanceBlendSpatialGrid::RemoveSlotAtSwap(int32 Slot)
+{
+	RemoveFromBucket(Slot);
+
+	// The last slot is moved into the vacated one, point its bucket entry at the new slot
+	const int32 Last = SlotRadii.Num() - 1;
+	if (Slot != Last)
+	{
+		GetBucket(Last)[SlotBucketIndices[Last]] = Slot;
+	}
+
+	SlotCells.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	SlotBucketIndices.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	SlotRadii.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+}
+
+void FDistanceBlendSpatialGrid::Query(const FDistanceBlendPool& Pool, const FVector3f& Target, bool bDistanceXY,
+	TArray<int32>& OutSlots) const
+{
+	OutSlots.Reset();
+	OutSlots.Append(Unbounded);
+
+	if (Cells.Num() == 0)
+	{
+		return;
+	}
+
+	auto TestBucket = [&](const TArray<int32>& Bucket)
+	{
+		for (const int32 Slot : Bucket)
+		{
+			const float DX = Target.X - Pool.LocationX[Slot];
+			const float DY = Target.Y - Pool.LocationY[Slot];
+			const float DZ = bDistanceXY ? 0.f : Target.Z - Pool.LocationZ[Slot];
+			if (DX * DX + DY * DY + DZ * DZ <= FMath::Square(SlotRadii[Slot]))
+			{
+				OutSlots.Add(Slot);
+			}
+		}
+	};
+
+	const FIntPoint Min = GetCell(Target - FVector3f(MaxRadius, MaxRadius, 0.f));
+	const FIntPoint Max = GetCell(Target + FVector3f(MaxRadius, MaxRadius, 0.f));
+	const int64 NumQueryCells = int64(Max.X - Min.X + 1) * int64(Max.Y - Min.Y + 1);
+
+	// Walking the occupied cells is cheaper when the query extent covers more cells than exist
+	if (NumQueryCells > Cells.Num())
+	{
+		for (const TPair<FIntPoint, TArray<int32>>& Cell : Cells)
+		{
+			if (Cell.Key.X >= Min.X && Cell.Key.X <= Max.X && Cell.Key.Y >= Min.Y && Cell.Key.Y <= Max.Y)
+			{
+				TestBucket(Cell.Value);
+			}
+		}
+		return;
+	}
+
+	for (int32 Y = Min.Y; Y <= Max.Y; Y++)
+	{
+		for (int32 X = Min.X; X <= Max.X; X++)
+		{
+			if (const TArray<int32>* Bucket = Cells.Find(FIntPoint(X, Y)))
+			{
+				TestBucket(*Bucket);
+			}
+		}
+	}
+}
+
+void FDistanceBlendSpatialGrid::AddToBucket(int32 Slot)
+{
+	TArray<int32>& Bucket = SlotRadii[Slot] > 0.f ? Cells.FindOrAdd(SlotCells[Slot]) : Unbounded;
+	SlotBucketIndices[Slot] = Bucket.Add(Slot);
+}
+
+void FDistanceBlendSpatialGrid::RemoveFromBucket(int32 Slot)
+{
+	TArray<int32>& Bucket = GetBucket(Slot);
+	const int32 BucketIndex = SlotBucketIndices[Slot];
+	Bucket.RemoveAtSwap(BucketIndex, 1, EAllowShrinking::No);
+	if (Bucket.IsValidIndex(BucketIndex))
+	{
+		SlotBucketIndices[Bucket[BucketIndex]] = BucketIndex;
+	}
+	SlotBucketIndices[Slot] = INDEX_NONE;
+}
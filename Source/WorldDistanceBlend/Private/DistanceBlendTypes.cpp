@@ -2,3 +2,187 @@
 
 
 #include "DistanceBlendTypes.h"
+
+#include "Camera/PlayerCameraManager.h"
+#include "Components/SceneComponent.h"
+#include "Curves/CurveFloat.h"
+#include "GameFramework/Actor.h"
+
+void FDistanceBlendCurveTable::Bake(const UCurveFloat* Curve)
+{
+	Reset();
+	if (!Curve || Curve->FloatCurve.GetNumKeys() == 0)
+	{
+		return;
+	}
+
+	float MinTime, MaxTime;
+	Curve->FloatCurve.GetTimeRange(MinTime, MaxTime);
+
+	const float Step = (MaxTime - MinTime) / (NumSamples - 1);
+	MinDistance = MinTime;
+	InvStep = Step > 0.f ? 1.f / Step : 0.f;
+
+	Samples.SetNumUninitialized(NumSamples + 1);
+	for (int32 i = 0; i < NumSamples; i++)
+	{
+		Samples[i] = FMath::Max(0.f, Curve->FloatCurve.Eval(MinTime + Step * i));
+	}
+	Samples[NumSamples] = Samples[NumSamples - 1];
+}
+
+void FDistanceBlendCurveTable::Reset()
+{
+	Samples.Reset();
+	MinDistance = 0.f;
+	InvStep = 0.f;
+}
+
+int32 FDistanceBlendPool::AddSlot()
+{
+	LocationX.Add(0.f);
+	LocationY.Add(0.f);
+	LocationZ.Add(0.f);
+	Scalars.Add(1.f);
+	Distances.Add(0.f);
+	DistanceBiases.Add(1.f);
+	SmoothedWeights.Add(0.f);
+	return BlendWeights.Add(0.f);
+}
+
+void FDistanceBlendPool::RemoveSlotAtSwap(int32 Slot)
+{
+	check(BlendWeights.IsValidIndex(Slot));
+
+	LocationX.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	LocationY.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	LocationZ.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	Scalars.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	Distances.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	DistanceBiases.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	BlendWeights.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	SmoothedWeights.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+}
+
+void FDistanceBlendPool::Reserve(int32 Capacity)
+{
+	LocationX.Reserve(Capacity);
+	LocationY.Reserve(Capacity);
+	LocationZ.Reserve(Capacity);
+	Scalars.Reserve(Capacity);
+	Distances.Reserve(Capacity);
+	DistanceBiases.Reserve(Capacity);
+	BlendWeights.Reserve(Capacity);
+	SmoothedWeights.Reserve(Capacity);
+}
+
+void FDistanceBlendPool::SetNum(int32 NewNum)
+{
+	LocationX.SetNum(NewNum, EAllowShrinking::No);
+	LocationY.SetNum(NewNum, EAllowShrinking::No);
+	LocationZ.SetNum(NewNum, EAllowShrinking::No);
+	Scalars.SetNum(NewNum, EAllowShrinking::No);
+	Distances.SetNum(NewNum, EAllowShrinking::No);
+	DistanceBiases.SetNum(NewNum, EAllowShrinking::No);
+	BlendWeights.SetNum(NewNum, EAllowShrinking::No);
+	SmoothedWeights.SetNum(NewNum, EAllowShrinking::No);
+}
+
+SIZE_T FDistanceBlendPool::GetAllocatedSize() const
+{
+	return LocationX.GetAllocatedSize() + LocationY.GetAllocatedSize() + LocationZ.GetAllocatedSize() +
+		Scalars.GetAllocatedSize() + Distances.GetAllocatedSize() + DistanceBiases.GetAllocatedSize() +
+		BlendWeights.GetAllocatedSize() + SmoothedWeights.GetAllocatedSize();
+}
+
+FDistanceBlendHandle FDistanceBlendHandleTable::Allocate(int32 Slot)
+{
+	const int32 Index = FreeIndices.Num() > 0 ? FreeIndices.Pop(EAllowShrinking::No) : Entries.AddDefaulted();
+
+	FEntry& Entry = Entries[Index];
+	Entry.Slot = Slot;
+
+	FDistanceBlendHandle Handle;
+	Handle.Index = Index;
+	Handle.Serial = Entry.Serial;
+	return Handle;
+}
+
+void FDistanceBlendHandleTable::Free(const FDistanceBlendHandle& Handle)
+{
+	if (GetSlot(Handle) == INDEX_NONE)
+	{
+		return;
+	}
+
+	// Bump the serial so existing copies of the handle become stale, skipping 0 on wrap
+	FEntry& Entry = Entries[Handle.Index];
+	Entry.Slot = INDEX_NONE;
+	Entry.Serial = FMath::Max(Entry.Serial + 1, 1u);
+	FreeIndices.Add(Handle.Index);
+}
+
+FDistanceBlendTargetProvider FDistanceBlendTargetProvider::FromActor(const AActor* Actor)
+{
+	FDistanceBlendTargetProvider Provider;
+	if (Actor)
+	{
+		Provider.Source = Actor;
+		if (Actor->IsA<APlayerCameraManager>())
+		{
+			Provider.Resolve = [](const FDistanceBlendTargetProvider& Self, FVector& OutLocation)
+			{
+				const APlayerCameraManager* CameraManager = static_cast<const APlayerCameraManager*>(Self.Source.Get());
+				if (CameraManager)
+				{
+					OutLocation = CameraManager->GetCameraLocation();
+				}
+				return CameraManager != nullptr;
+			};
+		}
+		else
+		{
+			Provider.Resolve = [](const FDistanceBlendTargetProvider& Self, FVector& OutLocation)
+			{
+				const AActor* Target = static_cast<const AActor*>(Self.Source.Get());
+				if (Target)
+				{
+					OutLocation = Target->GetActorLocation();
+				}
+				return Target != nullptr;
+			};
+		}
+	}
+	return Provider;
+}
+
+FDistanceBlendTargetProvider FDistanceBlendTargetProvider::FromComponent(const USceneComponent* Component)
+{
+	FDistanceBlendTargetProvider Provider;
+	if (Component)
+	{
+		Provider.Source = Component;
+		Provider.Resolve = [](const FDistanceBlendTargetProvider& Self, FVector& OutLocation)
+		{
+			const USceneComponent* Target = static_cast<const USceneComponent*>(Self.Source.Get());
+			if (Target)
+			{
+				OutLocation = Target->GetComponentLocation();
+			}
+			return Target != nullptr;
+		};
+	}
+	return Provider;
+}
+
+FDistanceBlendTargetProvider FDistanceBlendTargetProvider::FromLocation(const FVector& Location)
+{
+	FDistanceBlendTargetProvider Provider;
+	Provider.FixedLocation = Location;
+	Provider.Resolve = [](const FDistanceBlendTargetProvider& Self, FVector& OutLocation)
+	{
+		OutLocation = Self.FixedLocation;
+		return true;
+	};
+	return Provider;
+}
@@ -0,0 +1,95 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "DistanceBlendBenchmark.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && !UE_BUILD_SHIPPING
+
+using namespace DistanceBlend::Benchmark;
+
+BEGIN_DEFINE_SPEC(FDistanceBlendBenchmarkSpec, "WorldDistanceBlend.Benchmark",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+	/** Updates measured per case, after the first update which sizes scratch */
+	static constexpr int32 Iterations = 8;
+
+	void RunCase(EPattern Pattern, EDistanceBlendBenchmarkPath Path, int32 Num);
+
+END_DEFINE_SPEC(FDistanceBlendBenchmarkSpec)
+
+void FDistanceBlendBenchmarkSpec::Define()
+{
+	// 100k is left to wdb.Benchmark World, spawning that many actors for every case is too slow for a test pass
+	static constexpr int32 Counts[] = { 10, 100, 1000, 10000 };
+	static constexpr EPattern Patterns[] = { EPattern::Static, EPattern::Moving, EPattern::Streaming };
+	static constexpr EDistanceBlendBenchmarkPath Paths[] = { EDistanceBlendBenchmarkPath::SIMD, EDistanceBlendBenchmarkPath::Parallel,
+		EDistanceBlendBenchmarkPath::Culled, EDistanceBlendBenchmarkPath::Nearest, EDistanceBlendBenchmarkPath::Clustered };
+
+	for (const EPattern Pattern : Patterns)
+	{
+		Describe(LexToString(Pattern), [this, Pattern]
+		{
+			for (const EDistanceBlendBenchmarkPath Path : Paths)
+			{
+				for (const int32 Num : Counts)
+				{
+					It(FString::Printf(TEXT("%s matches the reference with %d components"), LexToString(Path), Num), [this, Pattern, Path, Num]
+					{
+						RunCase(Pattern, Path, Num);
+					});
+				}
+			}
+		});
+	}
+}
+
+void FDistanceBlendBenchmarkSpec::RunCase(EPattern Pattern, EDistanceBlendBenchmarkPath Path, int32 Num)
+{
+	FWorldConfig Config;
+	Config.Num = Num;
+	Config.Path = Path;
+	Config.Pattern = Pattern;
+	Config.ClusterOpeningAngle = 0.3f;
+
+	FWorldHarness Harness(Config);
+	if (!TestTrue(TEXT("Benchmark world created"), Harness.IsValid()))
+	{
+		return;
+	}
+
+	// Clusters approximate far sources, every other path must match the reference up to float rounding
+	const bool bApproximate = Path == EDistanceBlendBenchmarkPath::Clustered;
+	const float MaxTolerance = bApproximate ? 0.05f : 1.e-4f;
+	const float TotalTolerance = bApproximate ? 0.1f : 1.e-3f;
+
+	// Storage may grow only when cells are populated or the hierarchy is rebuilt with a different shape
+	const bool bExpectNoGrowth = Pattern == EPattern::Static || (Pattern == EPattern::Moving &&
+		Path != EDistanceBlendBenchmarkPath::Culled && Path != EDistanceBlendBenchmarkPath::Clustered);
+
+	Harness.Update();
+
+	double Microseconds = 0.0;
+	int64 Growth = 0;
+	for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+	{
+		Harness.ApplyPattern();
+		const FUpdateStats Stats = Harness.Update();
+		Microseconds += Stats.Microseconds;
+		Growth += Stats.AllocatedSizeDelta;
+
+		const FReferenceError Error = Harness.CompareToReference();
+		TestTrue(FString::Printf(TEXT("Update %d max error %g is within %g"), Iteration, Error.Max, MaxTolerance), Error.Max <= MaxTolerance);
+		TestTrue(FString::Printf(TEXT("Update %d total error %g is within %g"), Iteration, Error.Total, TotalTolerance), Error.Total <= TotalTolerance);
+	}
+
+	if (bExpectNoGrowth)
+	{
+		TestEqual(TEXT("Allocated size growth across steady state updates"), Growth, static_cast<int64>(0));
+	}
+
+	AddInfo(FString::Printf(TEXT("%s %s %d: %.2f us/update, %.1f KiB, %lld bytes growth"), LexToString(Pattern), LexToString(Path), Num,
+		Microseconds / Iterations, Harness.GetSubsystem()->GetAllocatedSize() / 1024.0, Growth));
+}
+
+#endif
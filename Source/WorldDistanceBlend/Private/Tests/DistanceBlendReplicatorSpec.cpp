@@ -0,0 +1,97 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "DistanceBlendReplicator.h"
+#include "Misc/AutomationTest.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+BEGIN_DEFINE_SPEC(FDistanceBlendReplicatorSpec, "WorldDistanceBlend.Replicator",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+	/** Weights sampled across [0, 1] for every round-trip */
+	static constexpr int32 Samples = 4096;
+
+	/** Quantize then serialize BlendWeight, @return The weight read back on the other end */
+	float RoundTrip(float BlendWeight, EDistanceBlendWeightPrecision Precision, int64& OutNumBits) const;
+
+END_DEFINE_SPEC(FDistanceBlendReplicatorSpec)
+
+float FDistanceBlendReplicatorSpec::RoundTrip(float BlendWeight, EDistanceBlendWeightPrecision Precision, int64& OutNumBits) const
+{
+	uint16 Sent = FDistanceBlendReplicatedWeight::Quantize(BlendWeight, Precision);
+	FBitWriter Writer(32, true);
+	FDistanceBlendReplicatedWeight::SerializeWeight(Writer, Sent);
+	OutNumBits = Writer.GetNumBits();
+
+	FDistanceBlendReplicatedWeight Received;
+	FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+	FDistanceBlendReplicatedWeight::SerializeWeight(Reader, Received.Weight);
+	return Received.GetBlendWeight();
+}
+
+void FDistanceBlendReplicatorSpec::Define()
+{
+	Describe(TEXT("Quantize"), [this]
+	{
+		It(TEXT("maps the ends of the range exactly and clamps beyond them"), [this]
+		{
+			for (const EDistanceBlendWeightPrecision Precision : { EDistanceBlendWeightPrecision::Bits8, EDistanceBlendWeightPrecision::Bits16 })
+			{
+				TestEqual(TEXT("Zero"), static_cast<int32>(FDistanceBlendReplicatedWeight::Quantize(0.f, Precision)), 0);
+				TestEqual(TEXT("One"), static_cast<int32>(FDistanceBlendReplicatedWeight::Quantize(1.f, Precision)), static_cast<int32>(MAX_uint16));
+				TestEqual(TEXT("Below zero"), static_cast<int32>(FDistanceBlendReplicatedWeight::Quantize(-1.f, Precision)), 0);
+				TestEqual(TEXT("Above one"), static_cast<int32>(FDistanceBlendReplicatedWeight::Quantize(2.f, Precision)), static_cast<int32>(MAX_uint16));
+			}
+		});
+
+		It(TEXT("only produces whole 8-bit steps for Bits8"), [this]
+		{
+			for (int32 Sample = 0; Sample <= Samples; Sample++)
+			{
+				const uint16 Weight = FDistanceBlendReplicatedWeight::Quantize(Sample / static_cast<float>(Samples), EDistanceBlendWeightPrecision::Bits8);
+				if (!TestEqual(FString::Printf(TEXT("Weight %d is a multiple of 257"), Weight), Weight % 257, 0))
+				{
+					break;
+				}
+			}
+		});
+	});
+
+	Describe(TEXT("SerializeWeight"), [this]
+	{
+		It(TEXT("round-trips Bits8 within half a step in 9 bits"), [this]
+		{
+			for (int32 Sample = 0; Sample <= Samples; Sample++)
+			{
+				const float BlendWeight = Sample / static_cast<float>(Samples);
+				int64 NumBits = 0;
+				const float Received = RoundTrip(BlendWeight, EDistanceBlendWeightPrecision::Bits8, NumBits);
+				if (!TestEqual(FString::Printf(TEXT("Bits sent for %f"), BlendWeight), NumBits, static_cast<int64>(9)) ||
+					!TestEqual(FString::Printf(TEXT("Weight received for %f"), BlendWeight), Received, BlendWeight, 0.5f / MAX_uint8 + UE_KINDA_SMALL_NUMBER))
+				{
+					break;
+				}
+			}
+		});
+
+		It(TEXT("round-trips Bits16 within half a step in at most 17 bits"), [this]
+		{
+			for (int32 Sample = 0; Sample <= Samples; Sample++)
+			{
+				const float BlendWeight = Sample / static_cast<float>(Samples);
+				int64 NumBits = 0;
+				const float Received = RoundTrip(BlendWeight, EDistanceBlendWeightPrecision::Bits16, NumBits);
+				if (!TestTrue(FString::Printf(TEXT("Bits sent for %f"), BlendWeight), NumBits == 9 || NumBits == 17) ||
+					!TestEqual(FString::Printf(TEXT("Weight received for %f"), BlendWeight), Received, BlendWeight, 0.5f / MAX_uint16 + UE_KINDA_SMALL_NUMBER))
+				{
+					break;
+				}
+			}
+		});
+	});
+}
+
+#endif
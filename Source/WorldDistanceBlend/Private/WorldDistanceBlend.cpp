@@ -1,6 +1,25 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "WorldDistanceBlend.h"
+#include "WorldDistanceBlendStats.h"
+
+DEFINE_LOG_CATEGORY(LogWorldDistanceBlend);
+
+UE_TRACE_CHANNEL_DEFINE(WorldDistanceBlendChannel);
+
+CSV_DEFINE_CATEGORY(WorldDistanceBlend, true);
+
+LLM_DEFINE_TAG(WorldDistanceBlend);
+
+DEFINE_STAT(STAT_WorldDistanceBlend_GetBlendWeights);
+DEFINE_STAT(STAT_WorldDistanceBlend_GatherScalars);
+DEFINE_STAT(STAT_WorldDistanceBlend_GatherDistances);
+DEFINE_STAT(STAT_WorldDistanceBlend_BiasWeights);
+DEFINE_STAT(STAT_WorldDistanceBlend_NormalizeWeights);
+DEFINE_STAT(STAT_WorldDistanceBlend_WriteBack);
+DEFINE_STAT(STAT_WorldDistanceBlend_Registered);
+DEFINE_STAT(STAT_WorldDistanceBlend_Evaluated);
+DEFINE_STAT(STAT_WorldDistanceBlend_Culled);
 
 #define LOCTEXT_NAMESPACE "FWorldDistanceBlendModule"
 
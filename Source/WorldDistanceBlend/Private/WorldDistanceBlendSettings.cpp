@@ -0,0 +1,11 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+
+#include "WorldDistanceBlendSettings.h"
+
+UWorldDistanceBlendSettings::UWorldDistanceBlendSettings(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	CategoryName = TEXT("Plugins");
+	SectionName = TEXT("WorldDistanceBlend");
+}
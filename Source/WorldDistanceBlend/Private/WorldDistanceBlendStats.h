@@ -0,0 +1,31 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogWorldDistanceBlend, Log, All);
+
+UE_TRACE_CHANNEL_EXTERN(WorldDistanceBlendChannel);
+
+CSV_DECLARE_CATEGORY_EXTERN(WorldDistanceBlend);
+
+/** Every persistent allocation made by the subsystem, visible with -llm or stat LLM */
+LLM_DECLARE_TAG(WorldDistanceBlend);
+
+DECLARE_STATS_GROUP(TEXT("WorldDistanceBlend"), STATGROUP_WorldDistanceBlend, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Get Blend Weights"), STAT_WorldDistanceBlend_GetBlendWeights, STATGROUP_WorldDistanceBlend, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Gather Scalars"), STAT_WorldDistanceBlend_GatherScalars, STATGROUP_WorldDistanceBlend, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Gather Distances"), STAT_WorldDistanceBlend_GatherDistances, STATGROUP_WorldDistanceBlend, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Bias Weights"), STAT_WorldDistanceBlend_BiasWeights, STATGROUP_WorldDistanceBlend, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Normalize Weights"), STAT_WorldDistanceBlend_NormalizeWeights, STATGROUP_WorldDistanceBlend, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Write Back"), STAT_WorldDistanceBlend_WriteBack, STATGROUP_WorldDistanceBlend, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Registered Components"), STAT_WorldDistanceBlend_Registered, STATGROUP_WorldDistanceBlend, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Evaluated Components"), STAT_WorldDistanceBlend_Evaluated, STATGROUP_WorldDistanceBlend, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Culled Components"), STAT_WorldDistanceBlend_Culled, STATGROUP_WorldDistanceBlend, );
@@ -2,3 +2,1839 @@
 
 
 #include "WorldDistanceBlendSubsystem.h"
+
+#include "DistanceBlendReplicator.h"
+#include "DistanceBlendSolver.h"
+#include "WorldDistanceBlendSettings.h"
+#include "WorldDistanceBlendStats.h"
+#include "Components/SceneComponent.h"
+#include "Curves/CurveFloat.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectIterator.h"
+#include "Tasks/Task.h"
+
+void UWorldDistanceBlendSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	SpatialGrid.Reset(SpatialIndexCellSize);
+	BakeWeightingCurves();
+	ReserveBlendSources(GetDefault<UWorldDistanceBlendSettings>()->PreallocateCapacity);
+
+#if WITH_EDITOR
+	for (const TPair<FName, UCurveFloat*>& Curve : WeightingCurves)
+	{
+		if (Curve.Value)
+		{
+			Curve.Value->OnUpdateCurve.AddUObject(this, &ThisClass::OnWeightingCurveUpdated);
+		}
+	}
+#endif
+}
+
+void UWorldDistanceBlendSubsystem::Deinitialize()
+{
+	WaitForPrecompute();
+	PrecomputeTask = {};
+
+	FGameModeEvents::GameModePostLoginEvent.Remove(PostLoginHandle);
+	FGameModeEvents::GameModeLogoutEvent.Remove(LogoutHandle);
+	PostLoginHandle.Reset();
+	LogoutHandle.Reset();
+	Replicators.Reset();
+
+	// Sources still registered at teardown never unregister, so remove them from the accumulator here
+	// Components are detached so a late unregister can't decrement them a second time
+	int32 NumRegistered = BlendComponents.Num();
+	for (UDistanceBlendComponent* BlendComponent : BlendComponents)
+	{
+		if (BlendComponent)
+		{
+			UnbindTransformUpdated(BlendComponent);
+			BlendComponent->BlendHandle.Reset();
+			BlendComponent->BlendSubsystem.Reset();
+		}
+	}
+	for (const TPair<FName, FDistanceBlendChannel>& Channel : BlendChannels)
+	{
+		NumRegistered += Channel.Value.Components.Num();
+		for (UDistanceBlendComponent* BlendComponent : Channel.Value.Components)
+		{
+			if (BlendComponent)
+			{
+				UnbindTransformUpdated(BlendComponent);
+				BlendComponent->BlendHandle.Reset();
+				BlendComponent->BlendSubsystem.Reset();
+				BlendComponent->RegisteredBlendChannel = NAME_None;
+			}
+		}
+	}
+	DEC_DWORD_STAT_BY(STAT_WorldDistanceBlend_Registered, NumRegistered);
+
+	BlendComponents.Reset();
+	SlotHandles.Reset();
+	BlendHandles = {};
+	Pool = {};
+	BlendChannels.Reset();
+
+#if WITH_EDITOR
+	for (const TPair<FName, UCurveFloat*>& Curve : WeightingCurves)
+	{
+		if (Curve.Value)
+		{
+			Curve.Value->OnUpdateCurve.RemoveAll(this);
+		}
+	}
+#endif
+
+	Super::Deinitialize();
+}
+
+void UWorldDistanceBlendSubsystem::ReserveBlendSources(int32 Capacity)
+{
+	LLM_SCOPE_BYTAG(WorldDistanceBlend);
+
+	if (Capacity <= BlendComponents.Max())
+	{
+		return;
+	}
+
+	// Scratch is read by the precompute task
+	WaitForPrecompute();
+
+	BlendComponents.Reserve(Capacity);
+	SlotHandles.Reserve(Capacity);
+	BlendHandles.Reserve(Capacity);
+	Pool.Reserve(Capacity);
+	BlendWeights.Reserve(Capacity);
+	LastValidBlendWeights.Reserve(Capacity);
+	PullScalarSlots.Reserve(Capacity);
+	WriteBackSlots.Reserve(Capacity);
+
+	if (bUseSpatialIndex || MaxInfluencers > 0)
+	{
+		SpatialGrid.Reserve(Capacity);
+		InfluencerSlots.Reserve(Capacity);
+		PreviousInfluencerSlots.Reserve(Capacity);
+		SelectionOrder.Reserve(Capacity);
+		WorkPool.Reserve(Capacity);
+	}
+	if (SweepBudgetMicroseconds > 0.f)
+	{
+		SweepDistances.Reserve(Capacity);
+	}
+
+	UpdatePeakAllocatedSize();
+}
+
+SIZE_T UWorldDistanceBlendSubsystem::GetAllocatedSize() const
+{
+	SIZE_T Size = BlendComponents.GetAllocatedSize() + Pool.GetAllocatedSize() + BlendHandles.GetAllocatedSize() +
+		SlotHandles.GetAllocatedSize() + PullScalarSlots.GetAllocatedSize() + WriteBackSlots.GetAllocatedSize() +
+		BlendWeights.GetAllocatedSize() + LastValidBlendWeights.GetAllocatedSize();
+
+	// Culling, clustering and sweep scratch
+	Size += SpatialGrid.GetAllocatedSize() + ClusterTree.GetAllocatedSize() + ClusterEntries.GetAllocatedSize() +
+		InfluencerSlots.GetAllocatedSize() + PreviousInfluencerSlots.GetAllocatedSize() + WorkPool.GetAllocatedSize() +
+		SelectionOrder.GetAllocatedSize() + SweepDistances.GetAllocatedSize() + SmoothedSlots.GetAllocatedSize() +
+		PreviousSmoothedSlots.GetAllocatedSize();
+
+	Size += WeightingCurveTables.GetAllocatedSize();
+	for (const TPair<FName, FDistanceBlendCurveTable>& Table : WeightingCurveTables)
+	{
+		Size += Table.Value.GetAllocatedSize();
+	}
+
+	Size += BlendChannels.GetAllocatedSize();
+	for (const TPair<FName, FDistanceBlendChannel>& Channel : BlendChannels)
+	{
+		const FDistanceBlendChannel& C = Channel.Value;
+		Size += C.Components.GetAllocatedSize() + C.Pool.GetAllocatedSize() + C.Handles.GetAllocatedSize() +
+			C.SlotHandles.GetAllocatedSize() + C.PullScalarSlots.GetAllocatedSize() + C.WriteBackSlots.GetAllocatedSize() +
+			C.BlendWeights.GetAllocatedSize();
+	}
+
+	Size += BlendTargets.GetAllocatedSize() + BlendTargetHandles.GetAllocatedSize();
+	for (const FDistanceBlendTarget& Target : BlendTargets)
+	{
+		Size += Target.Distances.GetAllocatedSize() + Target.DistanceBiases.GetAllocatedSize() +
+			Target.BlendWeights.GetAllocatedSize() + Target.Weights.GetAllocatedSize();
+	}
+	Size += TargetLocationScratch.GetAllocatedSize() + TargetDistanceScratch.GetAllocatedSize() + TargetTotalScratch.GetAllocatedSize();
+
+	Size += Subscriptions.GetAllocatedSize() + SubscriptionHandles.GetAllocatedSize();
+	for (const FDistanceBlendSubscription& Subscription : Subscriptions)
+	{
+		Size += Subscription.NotifiedWeights.GetAllocatedSize();
+	}
+
+	return Size + Replicators.GetAllocatedSize();
+}
+
+void UWorldDistanceBlendSubsystem::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(GetAllocatedSize());
+}
+
+void UWorldDistanceBlendSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Only a server with remote connections has anything to replicate
+	const ENetMode NetMode = InWorld.GetNetMode();
+	if (!ReplicatorClass || NetMode == NM_Client || NetMode == NM_Standalone)
+	{
+		return;
+	}
+
+	PostLoginHandle = FGameModeEvents::GameModePostLoginEvent.AddUObject(this, &ThisClass::OnPostLogin);
+	LogoutHandle = FGameModeEvents::GameModeLogoutEvent.AddUObject(this, &ThisClass::OnLogout);
+
+	for (FConstPlayerControllerIterator It = InWorld.GetPlayerControllerIterator(); It; ++It)
+	{
+		AddReplicator(It->Get());
+	}
+}
+
+void UWorldDistanceBlendSubsystem::OnPostLogin(AGameModeBase* GameMode, APlayerController* PlayerController)
+{
+	if (GameMode && GameMode->GetWorld() == GetWorld())
+	{
+		AddReplicator(PlayerController);
+	}
+}
+
+void UWorldDistanceBlendSubsystem::OnLogout(AGameModeBase* GameMode, AController* Controller)
+{
+	ADistanceBlendReplicator* Replicator = nullptr;
+	if (APlayerController* PlayerController = Cast<APlayerController>(Controller))
+	{
+		Replicators.RemoveAndCopyValue(PlayerController, Replicator);
+	}
+	if (Replicator)
+	{
+		Replicator->Destroy();
+	}
+}
+
+void UWorldDistanceBlendSubsystem::AddReplicator(APlayerController* PlayerController)
+{
+	// Local controllers on a listen server use the weights computed for the primary target
+	if (!PlayerController || PlayerController->IsLocalController() || Replicators.Contains(PlayerController))
+	{
+		return;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.Owner = PlayerController;
+	SpawnParams.ObjectFlags |= RF_Transient;
+	ADistanceBlendReplicator* Replicator = GetWorld()->SpawnActor<ADistanceBlendReplicator>(ReplicatorClass, SpawnParams);
+	if (Replicator)
+	{
+		Replicator->InitializeReplicator(this, PlayerController);
+		Replicators.Add(PlayerController, Replicator);
+	}
+}
+
+bool UWorldDistanceBlendSubsystem::UsesReplicatedBlendWeights() const
+{
+	return ReplicatorClass && GetWorld()->GetNetMode() == NM_Client;
+}
+
+void UWorldDistanceBlendSubsystem::ApplyReplicatedBlendWeights(TConstArrayView<FDistanceBlendReplicatedWeight> ReplicatedWeights)
+{
+	check(IsInGameThread());
+
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(UWorldDistanceBlendSubsystem::ApplyReplicatedBlendWeights, WorldDistanceBlendChannel);
+
+	CompletePrecompute();
+
+	const int32 Num = BlendComponents.Num();
+	for (int32 Slot = 0; Slot < Num; Slot++)
+	{
+		Pool.BlendWeights[Slot] = 0.f;
+		Pool.DistanceBiases[Slot] = 0.f;
+	}
+
+	bool bAnyApplied = false;
+	for (const FDistanceBlendReplicatedWeight& Replicated : ReplicatedWeights)
+	{
+		// Null if the component is not net addressable or has not replicated to this client yet
+		const UDistanceBlendComponent* BlendComponent = Replicated.Component;
+		if (BlendComponent && BlendComponent->RegisteredBlendChannel.IsNone() && IsBlendComponentRegistered(BlendComponent))
+		{
+			Pool.BlendWeights[GetBlendSlot(BlendComponent->BlendHandle)] = Replicated.GetBlendWeight();
+			bAnyApplied = true;
+		}
+	}
+
+	bComputedSelective = false;
+	bInfluencerSlotsStale = true;
+	LastUpdateFrame = GFrameCounter;
+	LastComputeTime = GetWorld()->GetTimeSeconds();
+	bInterpolatingBlendWeights = BlendWeightInterpSpeed > 0.f;
+	PublishBlendWeights(bAnyApplied);
+}
+
+void UWorldDistanceBlendSubsystem::BakeWeightingCurves()
+{
+	// Tables are read by the precompute task
+	CompletePrecompute();
+
+	WeightingCurveTables.Reset();
+	for (const TPair<FName, UCurveFloat*>& Curve : WeightingCurves)
+	{
+		FDistanceBlendCurveTable Table;
+		Table.Bake(Curve.Value);
+		if (Table.IsValid())
+		{
+			WeightingCurveTables.Add(Curve.Key, MoveTemp(Table));
+		}
+	}
+
+	MarkBlendInputsDirty();
+	RestartSweep();
+	for (TPair<FName, FDistanceBlendChannel>& Channel : BlendChannels)
+	{
+		Channel.Value.MarkInputsDirty();
+	}
+}
+
+#if WITH_EDITOR
+void UWorldDistanceBlendSubsystem::OnWeightingCurveUpdated(UCurveBase* Curve, EPropertyChangeType::Type ChangeType)
+{
+	// Dragging a key updates continuously, wait until the edit is committed
+	if (ChangeType != EPropertyChangeType::Interactive)
+	{
+		BakeWeightingCurves();
+	}
+}
+#endif
+
+void UWorldDistanceBlendSubsystem::Tick(float DeltaTime)
+{
+	LLM_SCOPE_BYTAG(WorldDistanceBlend);
+
+	Super::Tick(DeltaTime);
+
+	if (!bAsyncPrecompute || SweepBudgetMicroseconds > 0.f || UsesReplicatedBlendWeights())
+	{
+		return;
+	}
+
+	// Publish anything that was never consumed before starting the next precompute
+	CompletePrecompute();
+	bPrecomputeReused = false;
+
+	FVector TargetLocation;
+	if (IsWithinUpdateInterval() || !BlendTargetProvider.GetLocation(TargetLocation))
+	{
+		return;
+	}
+
+	// GetBlendScalar() can run Blueprint, so pulled scalars are gathered here on the game thread
+	const FVector3f Target { TargetLocation };
+	if (CanReuseBlendWeights(Target, bPrecomputeDistanceXY))
+	{
+		if (!GatherBlendScalars(true))
+		{
+			// Nothing changed, the current weights remain valid until the next consumer
+			bPrecomputeReused = true;
+			return;
+		}
+	}
+	else
+	{
+		GatherBlendScalars(false);
+	}
+
+	MarkBlendWeightsComputed(Target, bPrecomputeDistanceXY);
+	PrecomputeTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, Target]
+	{
+		LLM_SCOPE_BYTAG(WorldDistanceBlend);
+		bPrecomputeEvaluated = ComputeBlendWeights(Target, bPrecomputeDistanceXY, false);
+	});
+}
+
+TStatId UWorldDistanceBlendSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UWorldDistanceBlendSubsystem, STATGROUP_Tickables);
+}
+
+FDistanceBlendHandle UWorldDistanceBlendSubsystem::RegisterBlendComponent(UDistanceBlendComponent* BlendComponent)
+{
+	if (IsBlendComponentRegistered(BlendComponent))
+	{
+		return BlendComponent->BlendHandle;
+	}
+
+	// Slots must not change while a precompute is reading them
+	CompletePrecompute();
+
+	return RegisterBlendComponentInternal(BlendComponent);
+}
+
+void UWorldDistanceBlendSubsystem::UnregisterBlendComponent(UDistanceBlendComponent* BlendComponent)
+{
+	if (!IsBlendComponentRegistered(BlendComponent))
+	{
+		return;
+	}
+
+	// Slots must not change while a precompute is reading them
+	CompletePrecompute();
+
+	UnregisterBlendComponentInternal(BlendComponent);
+}
+
+void UWorldDistanceBlendSubsystem::RegisterBlendComponents(const TArray<UDistanceBlendComponent*>& InBlendComponents)
+{
+	CompletePrecompute();
+
+	ReserveBlendSources(BlendComponents.Num() + InBlendComponents.Num());
+
+	for (UDistanceBlendComponent* BlendComponent : InBlendComponents)
+	{
+		if (BlendComponent && !IsBlendComponentRegistered(BlendComponent))
+		{
+			RegisterBlendComponentInternal(BlendComponent);
+		}
+	}
+}
+
+void UWorldDistanceBlendSubsystem::UnregisterBlendComponents(const TArray<UDistanceBlendComponent*>& InBlendComponents)
+{
+	CompletePrecompute();
+
+	for (UDistanceBlendComponent* BlendComponent : InBlendComponents)
+	{
+		if (IsBlendComponentRegistered(BlendComponent))
+		{
+			UnregisterBlendComponentInternal(BlendComponent);
+		}
+	}
+}
+
+FDistanceBlendHandle UWorldDistanceBlendSubsystem::RegisterBlendComponentInternal(UDistanceBlendComponent* BlendComponent)
+{
+	BlendComponent->RegisteredBlendChannel = BlendComponent->BlendChannel;
+	if (!BlendComponent->RegisteredBlendChannel.IsNone())
+	{
+		return RegisterChannelBlendComponent(BlendComponent);
+	}
+
+	AActor* Owner = BlendComponent->GetOwner();
+	checkSlow(IsValid(Owner));
+
+	const FDistanceBlendHandle Handle = AddBlendSlot(BlendComponent, Owner->GetActorLocation(), BlendComponent->BlendScalar,
+		BlendComponent->MaxRelevanceRadius);
+	BlendComponent->BlendHandle = Handle;
+	BlendComponent->BlendSubsystem = this;
+	bPullScalarSlotsDirty |= BlendComponent->bPullBlendScalar;
+	bWriteBackSlotsDirty |= BlendComponent->bReceiveBlendWeight;
+
+	// Movable sources push their location only when they actually move
+	if (BlendComponent->Mobility == EDistanceBlendMobility::Movable)
+	{
+		if (USceneComponent* Root = Owner->GetRootComponent())
+		{
+			BlendComponent->TransformUpdatedHandle = Root->TransformUpdated.AddUObject(this,
+				&ThisClass::OnBlendSourceTransformUpdated, Handle);
+		}
+	}
+
+	return Handle;
+}
+
+void UWorldDistanceBlendSubsystem::UnbindTransformUpdated(UDistanceBlendComponent* BlendComponent)
+{
+	if (BlendComponent->TransformUpdatedHandle.IsValid())
+	{
+		if (USceneComponent* Root = BlendComponent->GetOwner() ? BlendComponent->GetOwner()->GetRootComponent() : nullptr)
+		{
+			Root->TransformUpdated.Remove(BlendComponent->TransformUpdatedHandle);
+		}
+		BlendComponent->TransformUpdatedHandle.Reset();
+	}
+}
+
+void UWorldDistanceBlendSubsystem::UnregisterBlendComponentInternal(UDistanceBlendComponent* BlendComponent)
+{
+	if (!BlendComponent->RegisteredBlendChannel.IsNone())
+	{
+		UnregisterChannelBlendComponent(BlendComponent);
+		return;
+	}
+
+	const int32 Slot = GetBlendSlot(BlendComponent->BlendHandle);
+	check(Slot != INDEX_NONE && BlendComponents[Slot] == BlendComponent);
+
+	UnbindTransformUpdated(BlendComponent);
+
+	RemoveBlendSlot(Slot);
+	BlendComponent->BlendHandle.Reset();
+	BlendComponent->BlendSubsystem.Reset();
+}
+
+FDistanceBlendHandle UWorldDistanceBlendSubsystem::AddBlendSlot(UDistanceBlendComponent* BlendComponent, const FVector& Location,
+	float Scalar, float MaxRelevanceRadius)
+{
+	LLM_SCOPE_BYTAG(WorldDistanceBlend);
+
+	const int32 Slot = BlendComponents.Add(BlendComponent);
+	const FDistanceBlendHandle Handle = BlendHandles.Allocate(Slot);
+	SlotHandles.Add(Handle);
+
+	Pool.AddSlot();
+	Pool.Scalars[Slot] = Scalar;
+	if (bUseSpatialIndex)
+	{
+		SpatialGrid.AddSlot(Slot, FVector3f(Location), MaxRelevanceRadius);
+	}
+	WriteBlendSourceLocation(Slot, Location);
+
+	INC_DWORD_STAT(STAT_WorldDistanceBlend_Registered);
+
+	bInfluencerSlotsStale = true;
+	MarkBlendInputsDirty();
+	RestartSweep();
+	return Handle;
+}
+
+void UWorldDistanceBlendSubsystem::RemoveBlendSlot(int32 Slot)
+{
+	const FDistanceBlendHandle Handle = SlotHandles[Slot];
+
+	// Swap the last slot into the vacated one so storage remains contiguous
+	BlendComponents.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	SlotHandles.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	RemoveSubscriptionSlot(NAME_None, Slot, Pool.Num());
+	Pool.RemoveSlotAtSwap(Slot);
+	if (bUseSpatialIndex)
+	{
+		SpatialGrid.RemoveSlotAtSwap(Slot);
+	}
+	if (SlotHandles.IsValidIndex(Slot))
+	{
+		BlendHandles.SetSlot(SlotHandles[Slot], Slot);
+	}
+	BlendHandles.Free(Handle);
+	ClusterTree.MarkDirty();
+
+	// Slots moved and the removed weight is gone from the smoothed set
+	bSmoothedSlotsStale = true;
+	bRenormalizeSmoothedWeights = true;
+	bInterpolatingBlendWeights = BlendWeightInterpSpeed > 0.f;
+	if (Pool.Num() == 0)
+	{
+		bSmoothedWeightsSeeded = false;
+	}
+
+	DEC_DWORD_STAT(STAT_WorldDistanceBlend_Registered);
+
+	bInfluencerSlotsStale = true;
+	MarkBlendInputsDirty();
+	RestartSweep();
+	bPullScalarSlotsDirty = true;
+	bWriteBackSlotsDirty = true;
+}
+
+FDistanceBlendHandle UWorldDistanceBlendSubsystem::RegisterBlendSource(const FVector& Location, float Scalar, float MaxRelevanceRadius)
+{
+	// Slots must not change while a precompute is reading them
+	CompletePrecompute();
+
+	return AddBlendSlot(nullptr, Location, Scalar, MaxRelevanceRadius);
+}
+
+void UWorldDistanceBlendSubsystem::UnregisterBlendSource(FDistanceBlendHandle Handle)
+{
+	const int32 Slot = GetBlendSlot(Handle);
+	if (Slot == INDEX_NONE || BlendComponents[Slot] != nullptr)
+	{
+		return;
+	}
+
+	CompletePrecompute();
+	RemoveBlendSlot(Slot);
+}
+
+void UWorldDistanceBlendSubsystem::SetBlendSourceLocation(FDistanceBlendHandle Handle, const FVector& Location)
+{
+	const int32 Slot = GetBlendSlot(Handle);
+	if (Slot == INDEX_NONE)
+	{
+		return;
+	}
+
+	// Callers typically push every frame, only dirty the inputs when the source actually moved
+	const FVector3f PackedLocation { Location };
+	if (Pool.LocationX[Slot] != PackedLocation.X || Pool.LocationY[Slot] != PackedLocation.Y || Pool.LocationZ[Slot] != PackedLocation.Z)
+	{
+		WriteBlendSourceLocation(Slot, Location);
+	}
+}
+
+void UWorldDistanceBlendSubsystem::SetBlendSourceScalar(FDistanceBlendHandle Handle, float Scalar)
+{
+	const int32 Slot = GetBlendSlot(Handle);
+	if (Slot != INDEX_NONE && Pool.Scalars[Slot] != Scalar)
+	{
+		WaitForPrecompute();
+		Pool.Scalars[Slot] = Scalar;
+		MarkBlendInputsDirty();
+	}
+}
+
+FDistanceBlendWeight UWorldDistanceBlendSubsystem::GetBlendComponentWeight(const UDistanceBlendComponent* BlendComponent) const
+{
+	if (!BlendComponent || BlendComponent->BlendSubsystem != this)
+	{
+		return FDistanceBlendWeight();
+	}
+
+	if (!BlendComponent->RegisteredBlendChannel.IsNone())
+	{
+		const FDistanceBlendChannel* Channel = BlendChannels.Find(BlendComponent->RegisteredBlendChannel);
+		const int32 Slot = Channel ? Channel->Handles.GetSlot(BlendComponent->BlendHandle) : INDEX_NONE;
+		return Channel && Channel->BlendWeights.IsValidIndex(Slot) ? Channel->BlendWeights[Slot] : FDistanceBlendWeight(Slot);
+	}
+
+	const int32 Slot = GetBlendSlot(BlendComponent->BlendHandle);
+	return BlendWeights.IsValidIndex(Slot) ? BlendWeights[Slot] : FDistanceBlendWeight(Slot);
+}
+
+void UWorldDistanceBlendSubsystem::WriteBackBlendWeights(FName ChannelName, TConstArrayView<FDistanceBlendWeight> Weights,
+	TConstArrayView<UDistanceBlendComponent*> Components, TArray<int32>& InWriteBackSlots, bool& bInWriteBackSlotsDirty)
+{
+	if (bInWriteBackSlotsDirty)
+	{
+		InWriteBackSlots.Reset();
+		for (int32 Slot = 0; Slot < Components.Num(); Slot++)
+		{
+			if (Components[Slot] && Components[Slot]->bReceiveBlendWeight)
+			{
+				InWriteBackSlots.Add(Slot);
+			}
+		}
+		bInWriteBackSlotsDirty = false;
+	}
+
+	for (const int32 Slot : InWriteBackSlots)
+	{
+		if (Weights.IsValidIndex(Slot))
+		{
+			Components[Slot]->BlendWeight = Weights[Slot];
+		}
+	}
+
+	OnBlendWeightsUpdated.Broadcast(ChannelName, Weights);
+	NotifySubscriptions(ChannelName, Weights);
+}
+
+FDistanceBlendHandle UWorldDistanceBlendSubsystem::SubscribeBlendWeightChanges(FName Channel, float Tolerance,
+	FOnDistanceBlendWeightsChanged Callback)
+{
+	LLM_SCOPE_BYTAG(WorldDistanceBlend);
+
+	FDistanceBlendSubscription& Subscription = Subscriptions.AddDefaulted_GetRef();
+	Subscription.Handle = SubscriptionHandles.Allocate(Subscriptions.Num() - 1);
+	Subscription.Channel = Channel;
+	Subscription.Tolerance = FMath::Max(0.f, Tolerance);
+	Subscription.Callback = MoveTemp(Callback);
+	return Subscription.Handle;
+}
+
+void UWorldDistanceBlendSubsystem::UnsubscribeBlendWeightChanges(FDistanceBlendHandle SubscriptionHandle)
+{
+	const int32 Index = SubscriptionHandles.GetSlot(SubscriptionHandle);
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	if (bNotifyingSubscriptions)
+	{
+		Subscriptions[Index].Callback.Unbind();
+		Subscriptions[Index].bPendingRemoval = true;
+		return;
+	}
+	RemoveSubscriptionAt(Index);
+}
+
+void UWorldDistanceBlendSubsystem::RemoveSubscriptionAt(int32 Index)
+{
+	const FDistanceBlendHandle Handle = Subscriptions[Index].Handle;
+	Subscriptions.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	if (Subscriptions.IsValidIndex(Index))
+	{
+		SubscriptionHandles.SetSlot(Subscriptions[Index].Handle, Index);
+	}
+	SubscriptionHandles.Free(Handle);
+}
+
+void UWorldDistanceBlendSubsystem::NotifySubscriptions(FName ChannelName, TConstArrayView<FDistanceBlendWeight> Weights)
+{
+	if (Subscriptions.IsEmpty() || bNotifyingSubscriptions)
+	{
+		return;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(UWorldDistanceBlendSubsystem::NotifySubscriptions, WorldDistanceBlendChannel);
+
+	TGuardValue<bool> NotifyingGuard(bNotifyingSubscriptions, true);
+
+	TArray<FDistanceBlendWeight, TInlineAllocator<16>> Changed;
+	const int32 Num = Weights.Num();
+
+	// Iterate by index, callbacks may subscribe and grow the array
+	for (int32 Index = 0; Index < Subscriptions.Num(); Index++)
+	{
+		if (Subscriptions[Index].Channel != ChannelName || Subscriptions[Index].bPendingRemoval)
+		{
+			continue;
+		}
+
+		Changed.Reset();
+		{
+			FDistanceBlendSubscription& Subscription = Subscriptions[Index];
+			const int32 NumNotified = Subscription.NotifiedWeights.Num();
+			if (NumNotified < Num)
+			{
+				Subscription.NotifiedWeights.AddZeroed(Num - NumNotified);
+			}
+
+			for (int32 Slot = 0; Slot < Num; Slot++)
+			{
+				float& Notified = Subscription.NotifiedWeights[Slot];
+				const float Weight = Weights[Slot].BlendWeight;
+				if (FMath::Abs(Weight - Notified) > Subscription.Tolerance)
+				{
+					Notified = Weight;
+					Changed.Add(Weights[Slot]);
+				}
+			}
+		}
+
+		if (Changed.Num() > 0)
+		{
+			// Copy out, the subscription may move if the callback subscribes
+			const FOnDistanceBlendWeightsChanged Callback = Subscriptions[Index].Callback;
+			Callback.ExecuteIfBound(ChannelName, Changed);
+		}
+	}
+
+	for (int32 Index = Subscriptions.Num() - 1; Index >= 0; Index--)
+	{
+		if (Subscriptions[Index].bPendingRemoval)
+		{
+			RemoveSubscriptionAt(Index);
+		}
+	}
+}
+
+void UWorldDistanceBlendSubsystem::RemoveSubscriptionSlot(FName ChannelName, int32 Slot, int32 NumSlots)
+{
+	for (FDistanceBlendSubscription& Subscription : Subscriptions)
+	{
+		TArray<float>& Notified = Subscription.NotifiedWeights;
+		if (Subscription.Channel == ChannelName && Notified.Num() > Slot)
+		{
+			// Baselines must cover every slot so the last slot's baseline swaps in, not a stale one
+			if (Notified.Num() < NumSlots)
+			{
+				Notified.AddZeroed(NumSlots - Notified.Num());
+			}
+			Notified.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+		}
+	}
+}
+
+float UWorldDistanceBlendSubsystem::GetBlendSourceWeight(FDistanceBlendHandle Handle) const
+{
+	const int32 Slot = GetBlendSlot(Handle);
+	if (Slot == INDEX_NONE || !bBlendWeightsValid)
+	{
+		return 0.f;
+	}
+	return BlendWeights.IsValidIndex(Slot) ? BlendWeights[Slot].BlendWeight : 0.f;
+}
+
+FDistanceBlendHandle UWorldDistanceBlendSubsystem::RegisterChannelBlendComponent(UDistanceBlendComponent* BlendComponent)
+{
+	LLM_SCOPE_BYTAG(WorldDistanceBlend);
+
+	AActor* Owner = BlendComponent->GetOwner();
+	checkSlow(IsValid(Owner));
+
+	const FName ChannelName = BlendComponent->RegisteredBlendChannel;
+	FDistanceBlendChannel& Channel = BlendChannels.FindOrAdd(ChannelName);
+
+	const int32 Slot = Channel.Components.Add(BlendComponent);
+	const FDistanceBlendHandle Handle = Channel.Handles.Allocate(Slot);
+	Channel.SlotHandles.Add(Handle);
+	BlendComponent->BlendHandle = Handle;
+	BlendComponent->BlendSubsystem = this;
+
+	Channel.Pool.AddSlot();
+	Channel.Pool.Scalars[Slot] = BlendComponent->BlendScalar;
+	WriteChannelBlendSourceLocation(Channel, Slot, Owner->GetActorLocation());
+
+	Channel.bPullScalarSlotsDirty |= BlendComponent->bPullBlendScalar;
+	Channel.bWriteBackSlotsDirty |= BlendComponent->bReceiveBlendWeight;
+	Channel.MarkInputsDirty();
+	INC_DWORD_STAT(STAT_WorldDistanceBlend_Registered);
+
+	if (BlendComponent->Mobility == EDistanceBlendMobility::Movable)
+	{
+		if (USceneComponent* Root = Owner->GetRootComponent())
+		{
+			BlendComponent->TransformUpdatedHandle = Root->TransformUpdated.AddUObject(this,
+				&ThisClass::OnChannelBlendSourceTransformUpdated, ChannelName, Handle);
+		}
+	}
+
+	return Handle;
+}
+
+void UWorldDistanceBlendSubsystem::UnregisterChannelBlendComponent(UDistanceBlendComponent* BlendComponent)
+{
+	FDistanceBlendChannel& Channel = BlendChannels.FindChecked(BlendComponent->RegisteredBlendChannel);
+	const int32 Slot = Channel.Handles.GetSlot(BlendComponent->BlendHandle);
+	check(Slot != INDEX_NONE && Channel.Components[Slot] == BlendComponent);
+
+	UnbindTransformUpdated(BlendComponent);
+
+	Channel.Components.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	Channel.SlotHandles.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	RemoveSubscriptionSlot(BlendComponent->RegisteredBlendChannel, Slot, Channel.Pool.Num());
+	Channel.Pool.RemoveSlotAtSwap(Slot);
+	if (Channel.SlotHandles.IsValidIndex(Slot))
+	{
+		Channel.Handles.SetSlot(Channel.SlotHandles[Slot], Slot);
+	}
+
+	Channel.Handles.Free(BlendComponent->BlendHandle);
+	BlendComponent->BlendHandle.Reset();
+	BlendComponent->BlendSubsystem.Reset();
+	BlendComponent->RegisteredBlendChannel = NAME_None;
+	DEC_DWORD_STAT(STAT_WorldDistanceBlend_Registered);
+
+	Channel.MarkInputsDirty();
+	Channel.bPullScalarSlotsDirty = true;
+	Channel.bWriteBackSlotsDirty = true;
+}
+
+void UWorldDistanceBlendSubsystem::OnChannelBlendSourceTransformUpdated(USceneComponent* UpdatedComponent,
+	EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport, FName ChannelName, FDistanceBlendHandle Handle)
+{
+	FDistanceBlendChannel& Channel = BlendChannels.FindChecked(ChannelName);
+	const int32 Slot = Channel.Handles.GetSlot(Handle);
+	checkSlow(Slot != INDEX_NONE);
+	WriteChannelBlendSourceLocation(Channel, Slot, UpdatedComponent->GetComponentLocation());
+}
+
+void UWorldDistanceBlendSubsystem::WriteChannelBlendSourceLocation(FDistanceBlendChannel& Channel, int32 Slot, const FVector& Location)
+{
+	const FVector3f PackedLocation { Location };
+	Channel.Pool.LocationX[Slot] = PackedLocation.X;
+	Channel.Pool.LocationY[Slot] = PackedLocation.Y;
+	Channel.Pool.LocationZ[Slot] = PackedLocation.Z;
+	Channel.MarkInputsDirty();
+}
+
+void UWorldDistanceBlendSubsystem::UpdateBlendComponentLocation(UDistanceBlendComponent* BlendComponent)
+{
+	if (BlendComponent && !BlendComponent->RegisteredBlendChannel.IsNone())
+	{
+		if (IsBlendComponentRegistered(BlendComponent) && IsValid(BlendComponent->GetOwner()))
+		{
+			FDistanceBlendChannel& Channel = BlendChannels.FindChecked(BlendComponent->RegisteredBlendChannel);
+			WriteChannelBlendSourceLocation(Channel, Channel.Handles.GetSlot(BlendComponent->BlendHandle),
+				BlendComponent->GetOwner()->GetActorLocation());
+		}
+		return;
+	}
+
+	const int32 Slot = BlendComponent ? GetBlendSlot(BlendComponent->BlendHandle) : INDEX_NONE;
+	if (Slot != INDEX_NONE && IsValid(BlendComponent->GetOwner()))
+	{
+		WriteBlendSourceLocation(Slot, BlendComponent->GetOwner()->GetActorLocation());
+	}
+}
+
+void UWorldDistanceBlendSubsystem::SetBlendComponentScalar(UDistanceBlendComponent* BlendComponent, float Scalar)
+{
+	if (BlendComponent && !BlendComponent->RegisteredBlendChannel.IsNone())
+	{
+		if (FDistanceBlendChannel* Channel = BlendChannels.Find(BlendComponent->RegisteredBlendChannel))
+		{
+			const int32 Slot = Channel->Handles.GetSlot(BlendComponent->BlendHandle);
+			if (Slot != INDEX_NONE && Channel->Pool.Scalars[Slot] != Scalar)
+			{
+				Channel->Pool.Scalars[Slot] = Scalar;
+				Channel->MarkInputsDirty();
+			}
+		}
+		return;
+	}
+
+	const int32 Slot = BlendComponent ? GetBlendSlot(BlendComponent->BlendHandle) : INDEX_NONE;
+	if (Slot != INDEX_NONE && Pool.Scalars[Slot] != Scalar)
+	{
+		WaitForPrecompute();
+		Pool.Scalars[Slot] = Scalar;
+		MarkBlendInputsDirty();
+	}
+}
+
+void UWorldDistanceBlendSubsystem::WriteBlendSourceLocation(int32 Slot, const FVector& Location)
+{
+	WaitForPrecompute();
+
+	const FVector3f PackedLocation { Location };
+	Pool.LocationX[Slot] = PackedLocation.X;
+	Pool.LocationY[Slot] = PackedLocation.Y;
+	Pool.LocationZ[Slot] = PackedLocation.Z;
+	MarkBlendInputsDirty();
+	ClusterTree.MarkDirty();
+
+	if (bUseSpatialIndex)
+	{
+		SpatialGrid.UpdateSlot(Slot, PackedLocation);
+	}
+}
+
+void UWorldDistanceBlendSubsystem::OnBlendSourceTransformUpdated(USceneComponent* UpdatedComponent,
+	EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport, FDistanceBlendHandle Handle)
+{
+	const int32 Slot = GetBlendSlot(Handle);
+	checkSlow(Slot != INDEX_NONE);
+	WriteBlendSourceLocation(Slot, UpdatedComponent->GetComponentLocation());
+}
+
+const TArray<FDistanceBlendWeight>& UWorldDistanceBlendSubsystem::GetBlendWeights(bool& bValid, bool bDistanceXY) const
+{
+	LLM_SCOPE_BYTAG(WorldDistanceBlend);
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(UWorldDistanceBlendSubsystem::GetBlendWeights, WorldDistanceBlendChannel);
+	SCOPE_CYCLE_COUNTER(STAT_WorldDistanceBlend_GetBlendWeights);
+	CSV_SCOPED_TIMING_STAT(WorldDistanceBlend, GetBlendWeights);
+
+	bValid = false;
+
+	UWorldDistanceBlendSubsystem* MutableThis = const_cast<UWorldDistanceBlendSubsystem*>(this);
+
+	// Clients only receive weights from the server, see ApplyReplicatedBlendWeights()
+	if (UsesReplicatedBlendWeights())
+	{
+		MutableThis->InterpolateBlendWeights();
+		bValid = bBlendWeightsValid;
+		return BlendWeights;
+	}
+
+	// Precomputed weights are for this frame, publish them rather than computing again
+	if (PrecomputeTask.IsValid())
+	{
+		MutableThis->CompletePrecompute();
+		MutableThis->InterpolateBlendWeights();
+		bValid = bBlendWeightsValid;
+		return BlendWeights;
+	}
+
+	// Tick found nothing changed, so the current weights stand in for a precompute
+	if (bPrecomputeReused)
+	{
+		MutableThis->bPrecomputeReused = false;
+		MutableThis->LastUpdateFrame = GFrameCounter;
+		MutableThis->InterpolateBlendWeights();
+		bValid = bBlendWeightsValid;
+		return BlendWeights;
+	}
+
+	FVector TargetLocation;
+	if (!BlendTargetProvider.GetLocation(TargetLocation))
+	{
+		return BlendWeights;
+	}
+	
+	// Time-sliced sweeps progress once per frame and publish only when complete
+	if (SweepBudgetMicroseconds > 0.f)
+	{
+		if (ShouldUpdateDistance())
+		{
+			MutableThis->LastUpdateFrame = GFrameCounter;
+			MutableThis->AdvanceSweep(FVector3f(TargetLocation), bDistanceXY);
+		}
+	}
+	// Don't compute new blend weights if already updated this frame, or updated recently enough
+	else if (ShouldUpdateDistance() && !IsWithinUpdateInterval())
+	{
+		MutableThis->LastUpdateFrame = GFrameCounter;
+
+		// Scalars are the only input that can change without notifying the subsystem
+		// If nothing changed, reuse the previous weights without writing back
+		const FVector3f Target { TargetLocation };
+		const bool bReuse = CanReuseBlendWeights(Target, bDistanceXY);
+		if (!bReuse || MutableThis->GatherBlendScalars(true))
+		{
+			// Compute new blend weights
+			const bool bEvaluated = MutableThis->ComputeBlendWeights(Target, bDistanceXY, !bReuse);
+			MutableThis->MarkBlendWeightsComputed(Target, bDistanceXY);
+			MutableThis->PublishBlendWeights(bEvaluated);
+		}
+	}
+
+	MutableThis->InterpolateBlendWeights();
+
+	bValid = bBlendWeightsValid;
+	return BlendWeights;
+}
+
+const TArray<FDistanceBlendWeight>& UWorldDistanceBlendSubsystem::GetChannelBlendWeights(FName Channel, bool& bValid,
+	bool bDistanceXY) const
+{
+	LLM_SCOPE_BYTAG(WorldDistanceBlend);
+
+	static const TArray<FDistanceBlendWeight> Empty;
+
+	if (Channel.IsNone())
+	{
+		return GetBlendWeights(bValid, bDistanceXY);
+	}
+
+	bValid = false;
+
+	const FDistanceBlendChannel* BlendChannel = BlendChannels.Find(Channel);
+	if (!BlendChannel)
+	{
+		return Empty;
+	}
+
+	// Don't compute new blend weights if already updated this frame
+	if (BlendChannel->LastUpdateFrame != GFrameCounter)
+	{
+		FDistanceBlendChannel& MutableChannel = const_cast<FDistanceBlendChannel&>(*BlendChannel);
+		MutableChannel.LastUpdateFrame = GFrameCounter;
+		const_cast<UWorldDistanceBlendSubsystem*>(this)->UpdateChannelBlendWeights(Channel, MutableChannel, bDistanceXY);
+	}
+
+	bValid = BlendChannel->bBlendWeightsValid;
+	return BlendChannel->BlendWeights;
+}
+
+void UWorldDistanceBlendSubsystem::UpdateChannelBlendWeights(FName ChannelName, FDistanceBlendChannel& Channel, bool bDistanceXY)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(UWorldDistanceBlendSubsystem::UpdateChannelBlendWeights, WorldDistanceBlendChannel);
+	CSV_SCOPED_TIMING_STAT(WorldDistanceBlend, UpdateChannelBlendWeights);
+
+	FVector TargetLocation;
+	const int32 Num = Channel.Components.Num();
+	if (Num == 0 || !BlendTargetProvider.GetLocation(TargetLocation))
+	{
+		Channel.BlendWeights.Reset();
+		Channel.bBlendWeightsValid = false;
+		return;
+	}
+
+	// Scalars are the only input that can change without notifying the subsystem
+	if (Channel.bPullScalarSlotsDirty)
+	{
+		Channel.PullScalarSlots.Reset();
+		for (int32 Slot = 0; Slot < Num; Slot++)
+		{
+			if (Channel.Components[Slot]->bPullBlendScalar)
+			{
+				Channel.PullScalarSlots.Add(Slot);
+			}
+		}
+		Channel.bPullScalarSlotsDirty = false;
+	}
+	for (const int32 Slot : Channel.PullScalarSlots)
+	{
+		const float Scalar = Channel.Components[Slot]->GetBlendScalar();
+		if (Scalar != Channel.Pool.Scalars[Slot])
+		{
+			Channel.Pool.Scalars[Slot] = Scalar;
+			Channel.MarkInputsDirty();
+		}
+	}
+
+	// Reuse the previous weights without writing back if nothing changed
+	const FVector3f Target { TargetLocation };
+	if (Channel.bBlendWeightsValid && Channel.ComputedInputsVersion == Channel.InputsVersion &&
+		Channel.bComputedDistanceXY == bDistanceXY &&
+		FVector3f::DistSquared(Target, Channel.ComputedTargetLocation) <= FMath::Square(TargetMovedTolerance))
+	{
+		return;
+	}
+	Channel.ComputedInputsVersion = Channel.InputsVersion;
+	Channel.ComputedTargetLocation = Target;
+	Channel.bComputedDistanceXY = bDistanceXY;
+
+	FDistanceBlendPool& ChannelPool = Channel.Pool;
+	const FDistanceBlendSolver::FBatches Batches = FDistanceBlendSolver::MakeBatches(Num, ParallelThreshold, ParallelBatchSize);
+	const float TotalDistances = FDistanceBlendSolver::ComputeDistances(ChannelPool, Target, bDistanceXY, Batches);
+	if (MaxInfluencers > 0 && Num > MaxInfluencers)
+	{
+		// Selection scratch is shared with the default channel's precompute
+		WaitForPrecompute();
+		SelectionOrder.SetNumUninitialized(Num, EAllowShrinking::No);
+		FDistanceBlendSolver::ComputeNearestWeights(ChannelPool.Scalars.GetData(), ChannelPool.Distances.GetData(),
+			ChannelPool.DistanceBiases.GetData(), ChannelPool.BlendWeights.GetData(), Num, MaxInfluencers, SelectionOrder,
+			GetWeighting(ChannelName));
+	}
+	else
+	{
+		FDistanceBlendSolver::ComputeWeights(ChannelPool, TotalDistances, Batches, GetWeighting(ChannelName));
+	}
+
+	// Update the Blueprint facing view in place
+	Channel.BlendWeights.SetNum(Num, EAllowShrinking::No);
+	for (int32 Slot = 0; Slot < Num; Slot++)
+	{
+		FDistanceBlendWeight& W = Channel.BlendWeights[Slot];
+		W.Slot = Slot;
+		W.BlendWeight = ChannelPool.BlendWeights[Slot];
+		W.DistanceBias = ChannelPool.DistanceBiases[Slot];
+		W.Dist = ChannelPool.Distances[Slot];
+	}
+	Channel.bBlendWeightsValid = true;
+	UpdatePeakAllocatedSize();
+
+	WriteBackBlendWeights(ChannelName, Channel.BlendWeights, Channel.Components, Channel.WriteBackSlots,
+		Channel.bWriteBackSlotsDirty);
+}
+
+FDistanceBlendHandle UWorldDistanceBlendSubsystem::AddBlendTargetProvider(const FDistanceBlendTargetProvider& Provider)
+{
+	LLM_SCOPE_BYTAG(WorldDistanceBlend);
+
+	FDistanceBlendTarget& Target = BlendTargets.AddDefaulted_GetRef();
+	Target.Handle = BlendTargetHandles.Allocate(BlendTargets.Num() - 1);
+	Target.Provider = Provider;
+
+	TargetsComputedInputsVersion = MAX_uint32;
+	return Target.Handle;
+}
+
+void UWorldDistanceBlendSubsystem::RemoveBlendTarget(FDistanceBlendHandle TargetHandle)
+{
+	const int32 Index = BlendTargetHandles.GetSlot(TargetHandle);
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	BlendTargets.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	if (BlendTargets.IsValidIndex(Index))
+	{
+		BlendTargetHandles.SetSlot(BlendTargets[Index].Handle, Index);
+	}
+	BlendTargetHandles.Free(TargetHandle);
+}
+
+const TArray<FDistanceBlendWeight>& UWorldDistanceBlendSubsystem::GetBlendWeightsForTarget(FDistanceBlendHandle TargetHandle,
+	bool& bValid, bool bDistanceXY) const
+{
+	LLM_SCOPE_BYTAG(WorldDistanceBlend);
+
+	static const TArray<FDistanceBlendWeight> Empty;
+
+	bValid = false;
+
+	const int32 Index = BlendTargetHandles.GetSlot(TargetHandle);
+	if (Index == INDEX_NONE)
+	{
+		return Empty;
+	}
+
+	// All additional targets are updated together once per frame
+	if (TargetsLastUpdateFrame != GFrameCounter)
+	{
+		UWorldDistanceBlendSubsystem* MutableThis = const_cast<UWorldDistanceBlendSubsystem*>(this);
+		MutableThis->TargetsLastUpdateFrame = GFrameCounter;
+		MutableThis->UpdateTargetBlendWeights(bDistanceXY);
+	}
+
+	const FDistanceBlendTarget& Target = BlendTargets[Index];
+	bValid = Target.bValid;
+	return Target.Weights;
+}
+
+void UWorldDistanceBlendSubsystem::UpdateTargetBlendWeights(bool bDistanceXY)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(UWorldDistanceBlendSubsystem::UpdateTargetBlendWeights, WorldDistanceBlendChannel);
+	CSV_SCOPED_TIMING_STAT(WorldDistanceBlend, UpdateTargetBlendWeights);
+
+	// Pool must not change underneath a precompute
+	WaitForPrecompute();
+	GatherBlendScalars(false);
+
+	const int32 Num = BlendComponents.Num();
+	const int32 NumTargets = BlendTargets.Num();
+
+	// Resolve every target, those without a valid location are not evaluated
+	TargetLocationScratch.Reset();
+	TargetDistanceScratch.Reset();
+	bool bAnyMoved = TargetsComputedInputsVersion != BlendInputsVersion || bTargetsComputedDistanceXY != bDistanceXY;
+	for (FDistanceBlendTarget& Target : BlendTargets)
+	{
+		FVector Location;
+		Target.bValid = Num > 0 && Target.Provider.GetLocation(Location);
+		if (Target.bValid)
+		{
+			const FVector3f PackedLocation { Location };
+			bAnyMoved |= Target.Weights.Num() != Num ||
+				FVector3f::DistSquared(PackedLocation, Target.LastComputedLocation) > FMath::Square(TargetMovedTolerance);
+
+			Target.Distances.SetNumUninitialized(Num, EAllowShrinking::No);
+			TargetLocationScratch.Add(PackedLocation);
+			TargetDistanceScratch.Add(Target.Distances.GetData());
+		}
+		else
+		{
+			Target.Weights.Reset();
+		}
+	}
+
+	if (!bAnyMoved || TargetLocationScratch.Num() == 0)
+	{
+		return;
+	}
+
+	TargetsComputedInputsVersion = BlendInputsVersion;
+	bTargetsComputedDistanceXY = bDistanceXY;
+
+	// Distance from every source to every target in one pass over the packed locations
+	const FDistanceBlendSolver::FBatches Batches = FDistanceBlendSolver::MakeBatches(Num, ParallelThreshold, ParallelBatchSize);
+	TargetTotalScratch.SetNumUninitialized(TargetLocationScratch.Num(), EAllowShrinking::No);
+	FDistanceBlendSolver::ComputeDistanceMatrix(Pool, TargetLocationScratch, bDistanceXY, TargetDistanceScratch.GetData(),
+		TargetTotalScratch.GetData(), Batches);
+
+	int32 Evaluated = 0;
+	for (int32 T = 0; T < NumTargets; T++)
+	{
+		FDistanceBlendTarget& Target = BlendTargets[T];
+		if (!Target.bValid)
+		{
+			continue;
+		}
+
+		Target.LastComputedLocation = TargetLocationScratch[Evaluated];
+		Target.DistanceBiases.SetNumUninitialized(Num, EAllowShrinking::No);
+		Target.BlendWeights.SetNumUninitialized(Num, EAllowShrinking::No);
+
+		if (MaxInfluencers > 0 && Num > MaxInfluencers)
+		{
+			SelectionOrder.SetNumUninitialized(Num, EAllowShrinking::No);
+			FDistanceBlendSolver::ComputeNearestWeights(Pool.Scalars.GetData(), Target.Distances.GetData(),
+				Target.DistanceBiases.GetData(), Target.BlendWeights.GetData(), Num, MaxInfluencers, SelectionOrder, GetWeighting());
+		}
+		else
+		{
+			FDistanceBlendSolver::ComputeWeights(Pool.Scalars.GetData(), Target.Distances.GetData(), Target.DistanceBiases.GetData(),
+				Target.BlendWeights.GetData(), Num, TargetTotalScratch[Evaluated], Batches, GetWeighting());
+		}
+
+		Target.Weights.SetNum(Num, EAllowShrinking::No);
+		for (int32 Slot = 0; Slot < Num; Slot++)
+		{
+			FDistanceBlendWeight& W = Target.Weights[Slot];
+			W.Slot = Slot;
+			W.BlendWeight = Target.BlendWeights[Slot];
+			W.DistanceBias = Target.DistanceBiases[Slot];
+			W.Dist = Target.Distances[Slot];
+		}
+
+		Evaluated++;
+	}
+}
+
+void UWorldDistanceBlendSubsystem::AdvanceSweep(const FVector3f& TargetLocation, bool bDistanceXY)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(UWorldDistanceBlendSubsystem::AdvanceSweep, WorldDistanceBlendChannel);
+
+	const int32 Num = BlendComponents.Num();
+	if (SweepCursor == INDEX_NONE)
+	{
+		if (Num == 0)
+		{
+			if (bBlendWeightsValid)
+			{
+				bComputedSelective = false;
+				PublishBlendWeights(false);
+			}
+			return;
+		}
+
+		// Only start a new sweep if something changed
+		if (IsWithinUpdateInterval() || (CanReuseBlendWeights(TargetLocation, bDistanceXY) && !GatherBlendScalars(true)))
+		{
+			return;
+		}
+
+		SweepCursor = 0;
+		SweepTargetLocation = TargetLocation;
+		bSweepDistanceXY = bDistanceXY;
+		SweepInputsVersion = BlendInputsVersion;
+		SweepTotalDistances = 0.f;
+		SweepDistances.SetNumUninitialized(Num, EAllowShrinking::No);
+		SweepStartTime = FPlatformTime::Seconds();
+		SweepFrames = 0;
+	}
+
+	// Gather whole chunks until the budget is spent, always making some progress
+	SweepFrames++;
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	const uint64 BudgetCycles = static_cast<uint64>(SweepBudgetMicroseconds / (FPlatformTime::GetSecondsPerCycle64() * 1000000.0));
+	const int32 ChunkSize = Align(FMath::Max(SweepChunkSize, FDistanceBlendSolver::FBatches::Alignment), FDistanceBlendSolver::FBatches::Alignment);
+	float* Distances = SweepDistances.GetData();
+	do
+	{
+		const int32 End = FMath::Min(SweepCursor + ChunkSize, Num);
+		float ChunkTotal = 0.f;
+		FDistanceBlendSolver::ComputeDistanceMatrix(Pool, MakeArrayView(&SweepTargetLocation, 1), bSweepDistanceXY, &Distances,
+			&ChunkTotal, SweepCursor, End);
+		SweepTotalDistances += ChunkTotal;
+		SweepCursor = End;
+	}
+	while (SweepCursor < Num && FPlatformTime::Cycles64() - StartCycles < BudgetCycles);
+
+	if (SweepCursor < Num)
+	{
+		return;
+	}
+
+	// Sweep complete, normalize against the distances it gathered
+	SweepCursor = INDEX_NONE;
+	LastSweepLatency = static_cast<float>(FPlatformTime::Seconds() - SweepStartTime);
+	LastSweepFrames = SweepFrames;
+
+	Swap(Pool.Distances, SweepDistances);
+	GatherBlendScalars(false);
+	if (MaxInfluencers > 0 && Num > MaxInfluencers)
+	{
+		SelectionOrder.SetNumUninitialized(Num, EAllowShrinking::No);
+		FDistanceBlendSolver::ComputeNearestWeights(Pool.Scalars.GetData(), Pool.Distances.GetData(), Pool.DistanceBiases.GetData(),
+			Pool.BlendWeights.GetData(), Num, MaxInfluencers, SelectionOrder, GetWeighting());
+	}
+	else
+	{
+		const FDistanceBlendSolver::FBatches Batches = FDistanceBlendSolver::MakeBatches(Num, ParallelThreshold, ParallelBatchSize);
+		FDistanceBlendSolver::ComputeWeights(Pool, SweepTotalDistances, Batches, GetWeighting());
+	}
+
+	// Every slot now has a weight, and anything that changed during the sweep requires another
+	bComputedSelective = false;
+	bInfluencerSlotsStale = true;
+	MarkBlendWeightsComputed(SweepTargetLocation, bSweepDistanceXY);
+	LastComputedInputsVersion = SweepInputsVersion;
+	PublishBlendWeights(true);
+}
+
+bool UWorldDistanceBlendSubsystem::IsWithinUpdateInterval() const
+{
+	return UpdateInterval > 0.f && bBlendWeightsValid && GetWorld()->GetTimeSeconds() - LastComputeTime < UpdateInterval;
+}
+
+void UWorldDistanceBlendSubsystem::MarkBlendWeightsComputed(const FVector3f& TargetLocation, bool bDistanceXY)
+{
+	LastComputedInputsVersion = BlendInputsVersion;
+	LastComputedTargetLocation = TargetLocation;
+	bLastComputedDistanceXY = bDistanceXY;
+	LastComputeTime = GetWorld()->GetTimeSeconds();
+	bInterpolatingBlendWeights = BlendWeightInterpSpeed > 0.f;
+}
+
+void UWorldDistanceBlendSubsystem::CompletePrecompute()
+{
+	if (!PrecomputeTask.IsValid())
+	{
+		return;
+	}
+
+	PrecomputeTask.Wait();
+	PrecomputeTask = {};
+
+	LastUpdateFrame = GFrameCounter;
+	PublishBlendWeights(bPrecomputeEvaluated);
+}
+
+bool UWorldDistanceBlendSubsystem::GatherBlendScalars(bool bEvaluatedOnly)
+{
+	check(IsInGameThread());
+
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(UWorldDistanceBlendSubsystem::GatherBlendScalars, WorldDistanceBlendChannel);
+	SCOPE_CYCLE_COUNTER(STAT_WorldDistanceBlend_GatherScalars);
+
+	bool bChanged = false;
+	auto Gather = [this, &bChanged](int32 Slot)
+	{
+		const float Scalar = BlendComponents[Slot]->GetBlendScalar();
+		if (Scalar != Pool.Scalars[Slot])
+		{
+			Pool.Scalars[Slot] = Scalar;
+			MarkBlendInputsDirty();
+			bChanged = true;
+		}
+	};
+
+	if (bEvaluatedOnly && bComputedSelective)
+	{
+		for (const int32 Slot : InfluencerSlots)
+		{
+			if (BlendComponents[Slot] && BlendComponents[Slot]->bPullBlendScalar)
+			{
+				Gather(Slot);
+			}
+		}
+		return bChanged;
+	}
+
+	if (bPullScalarSlotsDirty)
+	{
+		PullScalarSlots.Reset();
+		for (int32 Slot = 0; Slot < BlendComponents.Num(); Slot++)
+		{
+			if (BlendComponents[Slot] && BlendComponents[Slot]->bPullBlendScalar)
+			{
+				PullScalarSlots.Add(Slot);
+			}
+		}
+		bPullScalarSlotsDirty = false;
+	}
+
+	for (const int32 Slot : PullScalarSlots)
+	{
+		Gather(Slot);
+	}
+	return bChanged;
+}
+
+bool UWorldDistanceBlendSubsystem::ComputeBlendWeights(const FVector3f& TargetLocation, bool bDistanceXY, bool bGatherScalars)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(UWorldDistanceBlendSubsystem::ComputeBlendWeights, WorldDistanceBlendChannel);
+
+	const int32 Num = BlendComponents.Num();
+	if (Num == 0)
+	{
+		bComputedSelective = false;
+		return false;
+	}
+
+	bComputedSelective = bUseSpatialIndex || (MaxInfluencers > 0 && Num > MaxInfluencers);
+	if (bComputedSelective)
+	{
+		return ComputeSelectedBlendWeights(TargetLocation, bDistanceXY, bGatherScalars);
+	}
+	return ClusterOpeningAngle > 0.f
+		? ComputeClusteredBlendWeights(TargetLocation, bDistanceXY, bGatherScalars)
+		: ComputeAllBlendWeights(TargetLocation, bDistanceXY, bGatherScalars);
+}
+
+bool UWorldDistanceBlendSubsystem::ComputeAllBlendWeights(const FVector3f& TargetLocation, bool bDistanceXY, bool bGatherScalars)
+{
+	const int32 Num = BlendComponents.Num();
+
+	// Locations and pushed scalars are already packed, only components that pull their scalar are visited
+	if (bGatherScalars)
+	{
+		GatherBlendScalars(false);
+	}
+
+	const FDistanceBlendSolver::FBatches Batches = FDistanceBlendSolver::MakeBatches(Num, ParallelThreshold, ParallelBatchSize);
+	const float TotalDistances = FDistanceBlendSolver::ComputeDistances(Pool, TargetLocation, bDistanceXY, Batches);
+	FDistanceBlendSolver::ComputeWeights(Pool, TotalDistances, Batches, GetWeighting());
+
+	// Every slot now has a weight, a following selective update must clear them all
+	bInfluencerSlotsStale = true;
+
+	return true;
+}
+
+bool UWorldDistanceBlendSubsystem::ComputeClusteredBlendWeights(const FVector3f& TargetLocation, bool bDistanceXY, bool bGatherScalars)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(UWorldDistanceBlendSubsystem::ComputeClusteredBlendWeights, WorldDistanceBlendChannel);
+
+	if (bGatherScalars)
+	{
+		GatherBlendScalars(false);
+	}
+
+	ClusterTree.Update(Pool);
+	const float TotalDistances = ClusterTree.Gather(Pool, TargetLocation, bDistanceXY, ClusterOpeningAngle, ClusterEntries, WorkPool);
+	const int32 NumEntries = ClusterEntries.Num();
+	if (NumEntries == 0)
+	{
+		return false;
+	}
+
+	const FDistanceBlendSolver::FBatches Batches = FDistanceBlendSolver::MakeBatches(NumEntries, ParallelThreshold, ParallelBatchSize);
+	FDistanceBlendSolver::ComputeWeights(WorkPool, TotalDistances, Batches, GetWeighting());
+	ClusterTree.Scatter(ClusterEntries, WorkPool, Pool);
+
+	// Every slot now has a weight, a following selective update must clear them all
+	bInfluencerSlotsStale = true;
+
+	return true;
+}
+
+bool UWorldDistanceBlendSubsystem::ComputeSelectedBlendWeights(const FVector3f& TargetLocation, bool bDistanceXY, bool bGatherScalars)
+{
+	const int32 Num = BlendComponents.Num();
+
+	// Anything that influenced the last update but no longer does has its weight cleared
+	// Adding or removing slots reorders them, in which case every slot is cleared instead
+	Swap(InfluencerSlots, PreviousInfluencerSlots);
+	bClearAllOnPublish = bInfluencerSlotsStale;
+	bInfluencerSlotsStale = false;
+	if (bClearAllOnPublish)
+	{
+		for (int32 Slot = 0; Slot < Num; Slot++)
+		{
+			Pool.BlendWeights[Slot] = 0.f;
+			Pool.DistanceBiases[Slot] = 0.f;
+		}
+	}
+	else
+	{
+		for (const int32 Slot : PreviousInfluencerSlots)
+		{
+			Pool.BlendWeights[Slot] = 0.f;
+			Pool.DistanceBiases[Slot] = 0.f;
+		}
+	}
+
+	// Candidates are either the slots relevant to the target, or every slot
+	if (bUseSpatialIndex)
+	{
+		SpatialGrid.Query(Pool, TargetLocation, bDistanceXY, InfluencerSlots);
+	}
+	else
+	{
+		InfluencerSlots.SetNumUninitialized(Num, EAllowShrinking::No);
+		for (int32 Slot = 0; Slot < Num; Slot++)
+		{
+			InfluencerSlots[Slot] = Slot;
+		}
+	}
+
+	const int32 NumCandidates = InfluencerSlots.Num();
+	if (NumCandidates == 0)
+	{
+		return false;
+	}
+
+	// Gather candidates into contiguous scratch storage so the kernel remains vectorized
+	WorkPool.SetNum(NumCandidates);
+	for (int32 i = 0; i < NumCandidates; i++)
+	{
+		const int32 Slot = InfluencerSlots[i];
+		WorkPool.LocationX[i] = Pool.LocationX[Slot];
+		WorkPool.LocationY[i] = Pool.LocationY[Slot];
+		WorkPool.LocationZ[i] = Pool.LocationZ[Slot];
+	}
+	const FDistanceBlendSolver::FBatches CandidateBatches = FDistanceBlendSolver::MakeBatches(NumCandidates, ParallelThreshold, ParallelBatchSize);
+	float TotalDistances = FDistanceBlendSolver::ComputeDistances(WorkPool, TargetLocation, bDistanceXY, CandidateBatches);
+
+	// Only the nearest MaxInfluencers take part in normalization
+	if (MaxInfluencers > 0 && NumCandidates > MaxInfluencers)
+	{
+		SelectionOrder.SetNumUninitialized(NumCandidates, EAllowShrinking::No);
+		for (int32 i = 0; i < NumCandidates; i++)
+		{
+			SelectionOrder[i] = i;
+		}
+		FDistanceBlendSolver::SelectNearest(SelectionOrder, WorkPool.Distances.GetData(), MaxInfluencers);
+
+		// Selection is sorted ascending, so compacting in place never overwrites an unread entry
+		TotalDistances = 0.f;
+		for (int32 i = 0; i < MaxInfluencers; i++)
+		{
+			const int32 Selected = SelectionOrder[i];
+			InfluencerSlots[i] = InfluencerSlots[Selected];
+			WorkPool.Distances[i] = WorkPool.Distances[Selected];
+			TotalDistances += WorkPool.Distances[i];
+		}
+		InfluencerSlots.SetNum(MaxInfluencers, EAllowShrinking::No);
+		WorkPool.SetNum(MaxInfluencers);
+	}
+
+	const int32 NumInfluencers = InfluencerSlots.Num();
+	for (int32 i = 0; i < NumInfluencers; i++)
+	{
+		const int32 Slot = InfluencerSlots[i];
+		if (bGatherScalars)
+		{
+			// Null for sources registered without a component, components are expected to call UnregisterBlendComponent
+			const UDistanceBlendComponent* Comp = BlendComponents[Slot];
+			checkSlow(Comp == nullptr || Comp->BlendHandle == SlotHandles[Slot]);
+			if (Comp && Comp->bPullBlendScalar)
+			{
+				// Additional targets and the cluster tree only see scalar changes through the inputs version
+				const float Scalar = Comp->GetBlendScalar();
+				if (Scalar != Pool.Scalars[Slot])
+				{
+					Pool.Scalars[Slot] = Scalar;
+					MarkBlendInputsDirty();
+				}
+			}
+		}
+		WorkPool.Scalars[i] = Pool.Scalars[Slot];
+	}
+
+	const FDistanceBlendSolver::FBatches InfluencerBatches = FDistanceBlendSolver::MakeBatches(NumInfluencers, ParallelThreshold, ParallelBatchSize);
+	FDistanceBlendSolver::ComputeWeights(WorkPool, TotalDistances, InfluencerBatches, GetWeighting());
+
+	// Scatter results back to their slots
+	for (int32 i = 0; i < NumInfluencers; i++)
+	{
+		const int32 Slot = InfluencerSlots[i];
+		Pool.Distances[Slot] = WorkPool.Distances[i];
+		Pool.DistanceBiases[Slot] = WorkPool.DistanceBiases[i];
+		Pool.BlendWeights[Slot] = WorkPool.BlendWeights[i];
+	}
+
+	return true;
+}
+
+void UWorldDistanceBlendSubsystem::PublishBlendWeights(bool bEvaluated)
+{
+	check(IsInGameThread());
+
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(UWorldDistanceBlendSubsystem::PublishBlendWeights, WorldDistanceBlendChannel);
+	SCOPE_CYCLE_COUNTER(STAT_WorldDistanceBlend_WriteBack);
+	CSV_SCOPED_TIMING_STAT(WorldDistanceBlend, WriteBack);
+
+	// Keep the valid set before clearing, swapping buffers rather than copying
+	if (!bEvaluated)
+	{
+		RetainLastValidBlendWeights();
+	}
+
+	// Resize the view without releasing its allocation
+	const int32 Num = BlendComponents.Num();
+	BlendWeights.SetNum(Num, EAllowShrinking::No);
+
+	bBlendWeightsValid = bEvaluated;
+
+	// Start interpolating from the first valid set rather than from zero, which would not total 1.0
+	if (bEvaluated && BlendWeightInterpSpeed > 0.f && !bSmoothedWeightsSeeded)
+	{
+		bSmoothedWeightsSeeded = true;
+		bSmoothedSlotsStale = true;
+		if (!bComputedSelective)
+		{
+			FMemory::Memcpy(Pool.SmoothedWeights.GetData(), Pool.BlendWeights.GetData(), Num * sizeof(float));
+		}
+		else
+		{
+			for (const int32 Slot : InfluencerSlots)
+			{
+				Pool.SmoothedWeights[Slot] = Pool.BlendWeights[Slot];
+			}
+		}
+	}
+
+	if (!bComputedSelective)
+	{
+		// Update the Blueprint facing view in place, each batch writes a disjoint range of slots
+		if (bEvaluated)
+		{
+			// The view is Blueprint facing so can't use an aligned allocator, instead the slots before its first cache line
+			// boundary are written here, so that the batches after it start on a boundary and never share a line
+			static_assert(PLATFORM_CACHE_LINE_SIZE % sizeof(FDistanceBlendWeight) == 0);
+			const UPTRINT Misalignment = reinterpret_cast<UPTRINT>(BlendWeights.GetData()) % PLATFORM_CACHE_LINE_SIZE;
+			const int32 Lead = FMath::Min(Num, static_cast<int32>((PLATFORM_CACHE_LINE_SIZE - Misalignment) % PLATFORM_CACHE_LINE_SIZE / sizeof(FDistanceBlendWeight)));
+			for (int32 Slot = 0; Slot < Lead; Slot++)
+			{
+				WriteBlendWeight(Slot);
+			}
+
+			FDistanceBlendSolver::MakeBatches(Num - Lead, ParallelThreshold, ParallelBatchSize).ForEach([this, Lead](int32, int32 Begin, int32 End)
+			{
+				for (int32 Slot = Lead + Begin; Slot < Lead + End; Slot++)
+				{
+					WriteBlendWeight(Slot);
+				}
+			});
+		}
+	}
+	else
+	{
+		if (bClearAllOnPublish || bBlendWeightsStale)
+		{
+			for (int32 Slot = 0; Slot < Num; Slot++)
+			{
+				ClearBlendWeight(Slot);
+			}
+		}
+		else
+		{
+			for (const int32 Slot : PreviousInfluencerSlots)
+			{
+				ClearBlendWeight(Slot);
+			}
+		}
+
+		if (bEvaluated)
+		{
+			for (const int32 Slot : InfluencerSlots)
+			{
+				WriteBlendWeight(Slot);
+			}
+		}
+	}
+
+	const int32 NumEvaluated = !bEvaluated ? 0 : bComputedSelective ? InfluencerSlots.Num() : Num;
+	SET_DWORD_STAT(STAT_WorldDistanceBlend_Evaluated, NumEvaluated);
+	SET_DWORD_STAT(STAT_WorldDistanceBlend_Culled, Num - NumEvaluated);
+	CSV_CUSTOM_STAT(WorldDistanceBlend, Evaluated, NumEvaluated, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(WorldDistanceBlend, Culled, Num - NumEvaluated, ECsvCustomStatOp::Set);
+
+	// Every slot of the view is now current, and if valid it is also the last valid set
+	bBlendWeightsStale = false;
+	bLastValidIsFront = bEvaluated;
+	UpdatePeakAllocatedSize();
+
+	WriteBackBlendWeights(NAME_None, BlendWeights, BlendComponents, WriteBackSlots, bWriteBackSlotsDirty);
+}
+
+void UWorldDistanceBlendSubsystem::InterpolateBlendWeights()
+{
+	if (!bInterpolatingBlendWeights || !bBlendWeightsValid || LastInterpolatedFrame == GFrameCounter)
+	{
+		return;
+	}
+	LastInterpolatedFrame = GFrameCounter;
+
+	// Removing a slot drops its share of the smoothed set, rescale the remainder so it totals 1.0 again
+	if (bRenormalizeSmoothedWeights)
+	{
+		bRenormalizeSmoothedWeights = false;
+		float Total = 0.f;
+		for (const float Smoothed : Pool.SmoothedWeights)
+		{
+			Total += Smoothed;
+		}
+		if (Total > 0.f)
+		{
+			for (float& Smoothed : Pool.SmoothedWeights)
+			{
+				Smoothed /= Total;
+			}
+		}
+	}
+
+	// Frame rate independent exponential approach, a blend of two normalized sets remains normalized
+	// Both are, as the smoothed set is seeded from the first valid set and renormalized after removals
+	const float Alpha = 1.f - FMath::Exp(-BlendWeightInterpSpeed * GetWorld()->GetDeltaSeconds());
+
+	bool bConverged = true;
+	auto Interpolate = [this, Alpha, &bConverged](int32 Slot)
+	{
+		const float Target = Pool.BlendWeights[Slot];
+		float& Smoothed = Pool.SmoothedWeights[Slot];
+		Smoothed += (Target - Smoothed) * Alpha;
+		if (FMath::IsNearlyEqual(Smoothed, Target, KINDA_SMALL_NUMBER))
+		{
+			Smoothed = Target;
+		}
+		else
+		{
+			bConverged = false;
+		}
+
+		if (Smoothed != 0.f)
+		{
+			SmoothedSlots.Add(Slot);
+		}
+		BlendWeights[Slot].BlendWeight = Smoothed;
+	};
+
+	Swap(SmoothedSlots, PreviousSmoothedSlots);
+	SmoothedSlots.Reset();
+	if (!bComputedSelective || bInfluencerSlotsStale || bSmoothedSlotsStale)
+	{
+		const int32 Num = BlendComponents.Num();
+		for (int32 Slot = 0; Slot < Num; Slot++)
+		{
+			Interpolate(Slot);
+		}
+		bSmoothedSlotsStale = false;
+	}
+	else
+	{
+		// Every other slot has a zero computed and smoothed weight, so has nothing to interpolate
+		for (const int32 Slot : PreviousSmoothedSlots)
+		{
+			Interpolate(Slot);
+		}
+		for (const int32 Slot : InfluencerSlots)
+		{
+			// Slots already visited above have a nonzero smoothed weight unless their target is zero too
+			if (Pool.SmoothedWeights[Slot] == 0.f)
+			{
+				Interpolate(Slot);
+			}
+		}
+	}
+	bInterpolatingBlendWeights = !bConverged;
+
+	WriteBackBlendWeights(NAME_None, BlendWeights, BlendComponents, WriteBackSlots, bWriteBackSlotsDirty);
+}
+
+void UWorldDistanceBlendSubsystem::WriteBlendWeight(int32 Slot)
+{
+	FDistanceBlendWeight& W = BlendWeights[Slot];
+	W.Slot = Slot;
+	W.BlendWeight = BlendWeightInterpSpeed > 0.f ? Pool.SmoothedWeights[Slot] : Pool.BlendWeights[Slot];
+	W.DistanceBias = Pool.DistanceBiases[Slot];
+	W.Dist = Pool.Distances[Slot];
+}
+
+void UWorldDistanceBlendSubsystem::ClearBlendWeight(int32 Slot)
+{
+	FDistanceBlendWeight& W = BlendWeights[Slot];
+	W.Slot = Slot;
+	W.BlendWeight = BlendWeightInterpSpeed > 0.f ? Pool.SmoothedWeights[Slot] : 0.f;
+	W.DistanceBias = 0.f;
+	W.Dist = Pool.Distances[Slot];
+}
+
+#if !UE_BUILD_SHIPPING
+namespace DistanceBlend::Stats
+{
+	static void Run(UWorld* World)
+	{
+		UE_LOG(LogWorldDistanceBlend, Display, TEXT("%-40s %8s %8s %8s %12s %12s"), TEXT("Subsystem"), TEXT("Sources"),
+			TEXT("Capacity"), TEXT("Channels"), TEXT("Current KB"), TEXT("Peak KB"));
+
+		for (TObjectIterator<UWorldDistanceBlendSubsystem> It; It; ++It)
+		{
+			const UWorldDistanceBlendSubsystem* Subsystem = *It;
+			if (Subsystem->GetWorld() == World && !Subsystem->IsTemplate())
+			{
+				Subsystem->LogStats();
+			}
+		}
+	}
+}
+
+void UWorldDistanceBlendSubsystem::LogStats() const
+{
+	UE_LOG(LogWorldDistanceBlend, Display, TEXT("%-40s %8d %8d %8d %12.1f %12.1f"), *GetClass()->GetName(), BlendComponents.Num(),
+		BlendComponents.Max(), BlendChannels.Num(), GetAllocatedSize() / 1024.0, GetPeakAllocatedSize() / 1024.0);
+}
+
+static FAutoConsoleCommandWithWorld GDistanceBlendStatsCommand(
+	TEXT("wdb.Stats"),
+	TEXT("Log the current and peak heap memory held by each distance blend subsystem in the world, for per platform budgeting"),
+	FConsoleCommandWithWorldDelegate::CreateStatic(&DistanceBlend::Stats::Run));
+#endif
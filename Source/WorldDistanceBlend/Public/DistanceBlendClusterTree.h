@@ -0,0 +1,77 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FDistanceBlendPool;
+
+/**
+ * Bounding volume hierarchy over pool slots for Barnes-Hut style aggregation of far-field sources
+ * Clusters that are small relative to their distance from the target are weighted as a single source
+ * placed at their centroid and carrying the sum of their scalars, only nearby clusters are refined
+ * Rebuilt from the pool whenever locations change, so it suits large stationary far fields
+ */
+struct WORLDDISTANCEBLEND_API FDistanceBlendClusterTree
+{
+	/** Slots per leaf, leaves that are opened evaluate each slot individually */
+	static constexpr int32 LeafSize = 8;
+
+	/** Locations or slots changed, the tree is rebuilt on the next Gather */
+	void MarkDirty() { bDirty = true; }
+
+	/** Scalars changed, cluster scalar sums are refit on the next Gather */
+	void MarkScalarsDirty() { bScalarsDirty = true; }
+
+	/** Rebuild or refit if required */
+	void Update(const FDistanceBlendPool& Pool);
+
+	/**
+	 * Collect the sources and clusters to weight relative to the target
+	 * A node is treated as one source once its size is less than OpeningAngle times its distance
+	 * @param OutEntries Slot index for individual sources, or -(NodeIndex + 1) for clusters
+	 * @param Work Distances and Scalars are filled per entry
+	 * @return Total distance to scale Work by, so the average distance matches every source being evaluated
+	 */
+	float Gather(const FDistanceBlendPool& Pool, const FVector3f& Target, bool bDistanceXY, float OpeningAngle,
+		TArray<int32>& OutEntries, FDistanceBlendPool& Work) const;
+
+	/** Write the weighted entries back to their slots, cluster weight is shared by each member's scalar */
+	void Scatter(TConstArrayView<int32> Entries, const FDistanceBlendPool& Work, FDistanceBlendPool& Pool) const;
+
+	int32 NumNodes() const { return Nodes.Num(); }
+
+	SIZE_T GetAllocatedSize() const { return Nodes.GetAllocatedSize() + Order.GetAllocatedSize(); }
+
+private:
+	struct FNode
+	{
+		/** Centroid of the member locations, the position the cluster is weighted at */
+		FVector3f Center;
+
+		/** Largest extent of the member bounds */
+		float Size;
+
+		float ScalarSum;
+
+		/** Members are Order[Begin, Begin + Num) */
+		int32 Begin;
+		int32 Num;
+
+		/** Children are FirstChild and FirstChild + 1, INDEX_NONE for leaves */
+		int32 FirstChild;
+	};
+
+	void Build(const FDistanceBlendPool& Pool);
+	void BuildNode(const FDistanceBlendPool& Pool, int32 NodeIndex, int32 Begin, int32 Num);
+	void RefitScalars(const FDistanceBlendPool& Pool);
+
+	/** Children are always added after their parent, so reverse order visits children first */
+	TArray<FNode> Nodes;
+
+	/** Slots ordered so every node's members are contiguous */
+	TArray<int32> Order;
+
+	bool bDirty = true;
+	bool bScalarsDirty = true;
+};
@@ -7,18 +7,94 @@
 #include "Components/ActorComponent.h"
 #include "DistanceBlendComponent.generated.h"
 
+class UWorldDistanceBlendSubsystem;
 
 UCLASS(Abstract, ClassGroup=(Custom))
 class WORLDDISTANCEBLEND_API UDistanceBlendComponent : public UActorComponent
 {
 	GENERATED_BODY()
 
+	friend class UWorldDistanceBlendSubsystem;
+
+private:
+	/** Stable handle to this component's slot in the subsystem, assigned by RegisterBlendComponent */
+	FDistanceBlendHandle BlendHandle;
+
+	/** Bound to the owner's root component TransformUpdated while registered as Movable */
+	FDelegateHandle TransformUpdatedHandle;
+
+	/** Subsystem this component is registered with, receives SetBlendScalar() */
+	TWeakObjectPtr<UWorldDistanceBlendSubsystem> BlendSubsystem;
+
+	/** BlendChannel captured when registered, so later changes to it cannot orphan the slot */
+	FName RegisteredBlendChannel;
+
 public:
+	/** Written whenever the subsystem publishes weights, only if bReceiveBlendWeight, see GetLatestBlendWeight() */
 	UPROPERTY(BlueprintReadOnly, Category = DistanceBlend)
 	FDistanceBlendWeight BlendWeight;
+
+	/**
+	 * If true, BlendWeight is written back whenever the subsystem publishes weights
+	 * Otherwise nothing is written to this component, use GetLatestBlendWeight() to read it on demand
+	 * Changes take effect the next time the component is registered
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = DistanceBlend)
+	bool bReceiveBlendWeight = false;
+
+	/** Last weight the subsystem published for this component, without triggering an update */
+	UFUNCTION(BlueprintPure, Category = DistanceBlend)
+	FDistanceBlendWeight GetLatestBlendWeight() const;
+
+	/** Handle assigned when registered with a subsystem, unique within its BlendChannel, invalid while unregistered */
+	UFUNCTION(BlueprintPure, Category = DistanceBlend)
+	FDistanceBlendHandle GetBlendHandle() const { return BlendHandle; }
+
+	/**
+	 * Components are only normalized against others in the same channel, see GetChannelBlendWeights()
+	 * None uses the subsystem's default channel returned by GetBlendWeights()
+	 * Changes take effect the next time the component is registered
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = DistanceBlend)
+	FName BlendChannel = NAME_None;
+
+	/**
+	 * Static sources have their location captured once when registered
+	 * Movable sources update the subsystem only when the owner's root component moves
+	 * Changes take effect the next time the component is registered
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = DistanceBlend)
+	EDistanceBlendMobility Mobility = EDistanceBlendMobility::Movable;
+
+	/**
+	 * Beyond this distance from the target the component receives a weight of zero without being evaluated
+	 * Only used when the subsystem has a spatial index, 0 is always relevant
+	 * Changes take effect the next time the component is registered
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = DistanceBlend, meta = (UIMin = "0", ClampMin = "0", ForceUnits = "cm"))
+	float MaxRelevanceRadius = 0.f;
 	
+	/**
+	 * If true, GetBlendScalar() is called for this component every update
+	 * Otherwise the subsystem uses the value pushed by SetBlendScalar(), which avoids a Blueprint call per update
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = DistanceBlend)
+	bool bPullBlendScalar = false;
+
+protected:
+	/** How much blend weight this component has, use SetBlendScalar() at runtime */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = DistanceBlend, meta = (UIMin = "0", ClampMin = "0"))
+	float BlendScalar = 1.f;
+
 public:
-	/** Override to change how much blend weight this component has */
+	/** Change how much blend weight this component has, pushed to the subsystem immediately */
+	UFUNCTION(BlueprintCallable, Category = DistanceBlend)
+	void SetBlendScalar(float NewBlendScalar);
+
+	/**
+	 * Override to change how much blend weight this component has
+	 * Only called every update if bPullBlendScalar is enabled, defaults to BlendScalar
+	 */
 	UFUNCTION(BlueprintNativeEvent, Category = DistanceBlend)
 	float GetBlendScalar() const;
 
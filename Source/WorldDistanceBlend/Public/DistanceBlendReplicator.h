@@ -0,0 +1,176 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DistanceBlendTypes.h"
+#include "GameFramework/Info.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "DistanceBlendReplicator.generated.h"
+
+class APlayerController;
+class UDistanceBlendComponent;
+class UWorldDistanceBlendSubsystem;
+struct FDistanceBlendReplicatedWeights;
+
+/** Step size replicated weights are quantized to */
+UENUM(BlueprintType)
+enum class EDistanceBlendWeightPrecision : uint8
+{
+	/** 255 steps, small changes dirty fewer items */
+	Bits8,
+	/** 65535 steps */
+	Bits16,
+};
+
+/** A single server computed weight, quantized for replication */
+USTRUCT()
+struct WORLDDISTANCEBLEND_API FDistanceBlendReplicatedWeight : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	/** Source the weight applies to, must be net addressable (replicated or stably named) to resolve on the client */
+	UPROPERTY()
+	UDistanceBlendComponent* Component = nullptr;
+
+	/** BlendWeight quantized to [0, 65535], sent in 8 bits when it is a whole 8-bit step as Bits8 weights always are */
+	UPROPERTY()
+	uint16 Weight = 0;
+
+	float GetBlendWeight() const { return Weight / static_cast<float>(MAX_uint16); }
+
+	static uint16 Quantize(float BlendWeight, EDistanceBlendWeightPrecision Precision)
+	{
+		const float Clamped = FMath::Clamp(BlendWeight, 0.f, 1.f);
+		if (Precision == EDistanceBlendWeightPrecision::Bits8)
+		{
+			// 257 maps each 8-bit step exactly onto the 16-bit range
+			return static_cast<uint16>(FMath::RoundToInt(Clamped * MAX_uint8) * 257);
+		}
+		return static_cast<uint16>(FMath::RoundToInt(Clamped * MAX_uint16));
+	}
+
+	/** Write or read a quantized weight as a 1 bit flag followed by either its 8-bit step or all 16 bits */
+	static void SerializeWeight(FArchive& Ar, uint16& InOutWeight)
+	{
+		uint8 bStep = InOutWeight % 257 == 0;
+		Ar.SerializeBits(&bStep, 1);
+		if (bStep)
+		{
+			uint8 Step = static_cast<uint8>(InOutWeight / 257);
+			Ar << Step;
+			InOutWeight = Step * 257;
+		}
+		else
+		{
+			Ar << InOutWeight;
+		}
+	}
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FDistanceBlendReplicatedWeight> : public TStructOpsTypeTraitsBase2<FDistanceBlendReplicatedWeight>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
+/** Top weights for one connection, only items that changed are sent */
+USTRUCT()
+struct WORLDDISTANCEBLEND_API FDistanceBlendReplicatedWeights : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FDistanceBlendReplicatedWeight> Items;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FastArrayDeltaSerialize<FDistanceBlendReplicatedWeight, FDistanceBlendReplicatedWeights>(Items, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FDistanceBlendReplicatedWeights> : public TStructOpsTypeTraitsBase2<FDistanceBlendReplicatedWeights>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
+
+/**
+ * Server authoritative weights for one PlayerController, spawned by the subsystem when it has a ReplicatorClass
+ * The server evaluates the subsystem's default channel from the controller's camera and replicates the strongest
+ * MaxReplicatedWeights to the owning client only, which applies them instead of computing its own
+ * Weights outside the top MaxReplicatedWeights are zero, set the subsystem's MaxInfluencers to match so that the
+ * server's own GetBlendWeights() agrees with what clients see
+ */
+UCLASS(NotPlaceable)
+class WORLDDISTANCEBLEND_API ADistanceBlendReplicator : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+	ADistanceBlendReplicator(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+
+protected:
+	/** Subsystem evaluated on the server and applied to on the owning client */
+	UPROPERTY(Replicated)
+	TSubclassOf<UWorldDistanceBlendSubsystem> SubsystemClass;
+
+	UPROPERTY(ReplicatedUsing = OnRep_ReplicatedWeights)
+	FDistanceBlendReplicatedWeights ReplicatedWeights;
+
+	/**
+	 * Number of strongest weights replicated, every other source is zero on the client
+	 * Set in the derived class constructor
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = DistanceBlend, meta = (UIMin = "1", ClampMin = "1", UIMax = "32"))
+	int32 MaxReplicatedWeights = 8;
+
+	/**
+	 * Coarser precision means fewer items change between updates and each is sent in 8 bits rather than 16
+	 * Set in the derived class constructor
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = DistanceBlend)
+	EDistanceBlendWeightPrecision Precision = EDistanceBlendWeightPrecision::Bits16;
+
+	/** If true only get the distance in 2D Space (ignoring Z axis) */
+	UPROPERTY(EditDefaultsOnly, Category = DistanceBlend)
+	bool bDistanceXY = true;
+
+	/** Server only, the controller's camera registered as an additional subsystem target */
+	FDistanceBlendHandle TargetHandle;
+
+	/** Server only, scratch storage for the strongest slots, ordered by descending weight */
+	TArray<int32> StrongestSlots;
+
+public:
+	/** Server only, called by the subsystem immediately after spawning */
+	void InitializeReplicator(UWorldDistanceBlendSubsystem* Subsystem, APlayerController* PlayerController);
+
+	/** Replicated weights, identical on the server and the owning client */
+	TConstArrayView<FDistanceBlendReplicatedWeight> GetReplicatedBlendWeights() const { return ReplicatedWeights.Items; }
+
+	/** @return The replicated weight for a component, zero if it is not among the strongest */
+	UFUNCTION(BlueprintPure, Category = DistanceBlend)
+	float GetReplicatedBlendWeight(const UDistanceBlendComponent* BlendComponent) const;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual void Tick(float DeltaSeconds) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+protected:
+	UWorldDistanceBlendSubsystem* GetSubsystem() const;
+
+	/** Select, quantize and diff the strongest weights into ReplicatedWeights */
+	void UpdateReplicatedWeights(UWorldDistanceBlendSubsystem* Subsystem);
+
+	UFUNCTION()
+	void OnRep_ReplicatedWeights();
+};
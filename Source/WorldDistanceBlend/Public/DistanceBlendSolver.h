@@ -0,0 +1,365 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DistanceBlendTypes.h"
+#include "Async/ParallelFor.h"
+#include "Math/VectorRegister.h"
+
+/**
+ * Distance blend computation operating only on spans of packed data, never touching UObjects
+ * Everything is static and stateless, so it is safe to use from any thread, eg. the audio thread or Mass processors
+ * Solve and SolveNearest always run serially on the calling thread and never allocate
+ * Overloads taking FBatches only dispatch to the task graph and allocate when the batches are parallel
+ * UWorldDistanceBlendSubsystem is an adapter that packs component data and calls into this
+ */
+struct WORLDDISTANCEBLEND_API FDistanceBlendSolver
+{
+	/** Sources to solve for, every view must be the same length */
+	struct FInput
+	{
+		TConstArrayView<float> LocationX;
+		TConstArrayView<float> LocationY;
+		TConstArrayView<float> LocationZ;
+		TConstArrayView<float> Scalars;
+
+		int32 Num() const { return Scalars.Num(); }
+	};
+
+	/** Per source results, every view must be the same length as the input */
+	struct FOutput
+	{
+		TArrayView<float> Distances;
+		TArrayView<float> DistanceBiases;
+		TArrayView<float> BlendWeights;
+	};
+
+	/** Weighting function mapping each source's distance to a bias, see EDistanceBlendWeighting */
+	struct FWeighting
+	{
+		EDistanceBlendWeighting Policy = EDistanceBlendWeighting::InverseDistance;
+
+		/** Distance at which EDistanceBlendWeighting::RadiusFalloff reaches zero */
+		float FalloffRadius = 0.f;
+
+		/** Table sampled by EDistanceBlendWeighting::Curve, falls back to InverseDistance if null or not baked */
+		const FDistanceBlendCurveTable* Curve = nullptr;
+
+		/**
+		 * Distances are clamped to at least this before InverseDistance and InverseSquare divide by them
+		 * A source at the target then dominates with a large but finite weight instead of producing Inf or NaN
+		 */
+		float MinDistance = 1.f;
+	};
+
+	/**
+	 * Weighting policies, constructed once per solve and invoked per source or per 4 sources
+	 * Kernels take the policy as a template parameter, so each one is inlined into its own loop
+	 */
+	struct FInverseDistance
+	{
+		/** The average is clamped too, so every source sitting on the target shares the weight equally */
+		FInverseDistance(float AverageDistances, const FWeighting& Weighting)
+			: MinDistance(FMath::Max(Weighting.MinDistance, UE_KINDA_SMALL_NUMBER))
+			, Average(FMath::Max(AverageDistances, MinDistance))
+			, MinDistanceV(VectorSetFloat1(MinDistance))
+			, AverageV(VectorSetFloat1(Average))
+		{}
+
+		float operator()(float Dist) const { return Average / FMath::Max(Dist, MinDistance); }
+
+		VectorRegister4Float operator()(const VectorRegister4Float& Dist) const
+		{
+			return VectorDivide(AverageV, VectorMax(Dist, MinDistanceV));
+		}
+
+		float MinDistance;
+		float Average;
+		VectorRegister4Float MinDistanceV;
+		VectorRegister4Float AverageV;
+	};
+
+	struct FInverseSquare
+	{
+		FInverseSquare(float AverageDistances, const FWeighting& Weighting)
+			: Inverse(AverageDistances, Weighting)
+		{}
+
+		float operator()(float Dist) const
+		{
+			const float Bias = Inverse(Dist);
+			return Bias * Bias;
+		}
+
+		VectorRegister4Float operator()(const VectorRegister4Float& Dist) const
+		{
+			const VectorRegister4Float Bias = Inverse(Dist);
+			return VectorMultiply(Bias, Bias);
+		}
+
+		FInverseDistance Inverse;
+	};
+
+	struct FRadiusFalloff
+	{
+		FRadiusFalloff(float, const FWeighting& Weighting)
+			: InvRadius(1.f / FMath::Max(Weighting.FalloffRadius, UE_KINDA_SMALL_NUMBER))
+			, InvRadiusV(VectorSetFloat1(InvRadius))
+		{}
+
+		float operator()(float Dist) const { return FMath::Max(0.f, 1.f - Dist * InvRadius); }
+
+		VectorRegister4Float operator()(const VectorRegister4Float& Dist) const
+		{
+			return VectorMax(VectorZeroFloat(), VectorSubtract(VectorOneFloat(), VectorMultiply(Dist, InvRadiusV)));
+		}
+
+		float InvRadius;
+		VectorRegister4Float InvRadiusV;
+	};
+
+	struct FCurve
+	{
+		FCurve(float, const FWeighting& Weighting)
+			: Table(*Weighting.Curve)
+			, MinDistanceV(VectorSetFloat1(Table.MinDistance))
+			, InvStepV(VectorSetFloat1(Table.InvStep))
+			, MaxIndexV(VectorSetFloat1(static_cast<float>(FDistanceBlendCurveTable::NumSamples - 1)))
+		{}
+
+		float operator()(float Dist) const { return Table.Sample(Dist); }
+
+		/** Sample indices are computed 4-wide, then both neighbours are gathered per lane and interpolated 4-wide */
+		VectorRegister4Float operator()(const VectorRegister4Float& Dist) const
+		{
+			const VectorRegister4Float T = VectorMin(VectorMax(VectorMultiply(VectorSubtract(Dist, MinDistanceV), InvStepV),
+				VectorZeroFloat()), MaxIndexV);
+			const VectorRegister4Float Index = VectorFloor(T);
+
+			alignas(16) float Indices[4];
+			alignas(16) float Lo[4];
+			alignas(16) float Hi[4];
+			VectorStoreAligned(Index, Indices);
+			const float* RESTRICT Samples = Table.Samples.GetData();
+			for (int32 Lane = 0; Lane < 4; Lane++)
+			{
+				const int32 Sample = static_cast<int32>(Indices[Lane]);
+				Lo[Lane] = Samples[Sample];
+				Hi[Lane] = Samples[Sample + 1];
+			}
+
+			const VectorRegister4Float A = VectorLoadAligned(Lo);
+			return VectorMultiplyAdd(VectorSubtract(VectorLoadAligned(Hi), A), VectorSubtract(T, Index), A);
+		}
+
+		const FDistanceBlendCurveTable& Table;
+		VectorRegister4Float MinDistanceV;
+		VectorRegister4Float InvStepV;
+		VectorRegister4Float MaxIndexV;
+	};
+
+	/**
+	 * Weight every source relative to the target, normalized to total 1.0
+	 * Serial and allocation free, safe on any thread
+	 * @return False if there are no sources
+	 */
+	static bool Solve(const FInput& In, const FVector3f& Target, bool bDistanceXY, const FOutput& Out,
+		const FWeighting& Weighting = FWeighting());
+
+	/**
+	 * Weight only the nearest MaxInfluencers sources relative to the target, every other source receives zero
+	 * Serial and allocation free, safe on any thread
+	 * @param OrderScratch Caller owned scratch of at least In.Num() entries
+	 * @return False if there are no sources
+	 */
+	static bool SolveNearest(const FInput& In, const FVector3f& Target, bool bDistanceXY, int32 MaxInfluencers,
+		TArrayView<int32> OrderScratch, const FOutput& Out, const FWeighting& Weighting = FWeighting());
+
+	/** @return View of every slot in the pool as solver input */
+	static FInput MakeInput(const FDistanceBlendPool& Pool)
+	{
+		return { Pool.LocationX, Pool.LocationY, Pool.LocationZ, Pool.Scalars };
+	}
+
+	/** @return View of every slot in the pool as solver output */
+	static FOutput MakeOutput(FDistanceBlendPool& Pool)
+	{
+		return { Pool.Distances, Pool.DistanceBiases, Pool.BlendWeights };
+	}
+
+	/**
+	 * Fixed size batches a pool is processed in, optionally in parallel
+	 * Reductions are performed per batch then summed in batch order, so results depend only on the batch size
+	 * and are bit-identical regardless of thread count or whether the batches run in parallel
+	 * Serial batches run inline on the calling thread and never allocate, parallel batches use ParallelFor and
+	 * heap allocate their partial sums above 64 batches
+	 */
+	struct FBatches
+	{
+		/**
+		 * Batches are a multiple of at least 16 elements and of a cache line of floats, so batches over
+		 * FDistanceBlendFloatArray stay vector aligned and never share a cache line with their neighbours
+		 */
+		static constexpr int32 Alignment = FMath::Max(16, static_cast<int32>(PLATFORM_CACHE_LINE_SIZE / sizeof(float)));
+
+		FBatches(int32 InNum, int32 InBatchSize, bool bInParallel)
+			: Num(InNum)
+			, BatchSize(Align(FMath::Max(InBatchSize, Alignment), Alignment))
+			, NumBatches(FMath::DivideAndRoundUp(InNum, BatchSize))
+			, bParallel(bInParallel && NumBatches > 1)
+		{}
+
+		/** Invoke Fn(Batch, Begin, End) for every batch */
+		template<typename FuncType>
+		void ForEach(FuncType&& Fn) const
+		{
+			if (!bParallel)
+			{
+				for (int32 Batch = 0; Batch < NumBatches; Batch++)
+				{
+					const int32 Begin = Batch * BatchSize;
+					Fn(Batch, Begin, FMath::Min(Begin + BatchSize, Num));
+				}
+				return;
+			}
+
+			ParallelFor(NumBatches, [this, &Fn](int32 Batch)
+			{
+				const int32 Begin = Batch * BatchSize;
+				Fn(Batch, Begin, FMath::Min(Begin + BatchSize, Num));
+			});
+		}
+
+		/** Invoke Fn(Begin, End) for every batch and sum the results in batch order */
+		template<typename FuncType>
+		float Sum(FuncType&& Fn) const
+		{
+			float Total = 0.f;
+			if (!bParallel)
+			{
+				// Accumulating in batch order matches summing the partials, without needing somewhere to store them
+				ForEach([&Total, &Fn](int32, int32 Begin, int32 End)
+				{
+					Total += Fn(Begin, End);
+				});
+				return Total;
+			}
+
+			TArray<float, TInlineAllocator<64>> Partials;
+			Partials.SetNumUninitialized(NumBatches);
+			ForEach([&Partials, &Fn](int32 Batch, int32 Begin, int32 End)
+			{
+				Partials[Batch] = Fn(Begin, End);
+			});
+
+			for (const float Partial : Partials)
+			{
+				Total += Partial;
+			}
+			return Total;
+		}
+
+		int32 Num;
+		int32 BatchSize;
+		int32 NumBatches;
+		bool bParallel;
+	};
+
+	/** Batches for processing Num slots, parallel at or above Threshold */
+	static FBatches MakeBatches(int32 Num, int32 Threshold, int32 BatchSize)
+	{
+		return FBatches(Num, BatchSize, Threshold > 0 && Num >= Threshold);
+	}
+
+	/**
+	 * Compute the distance to the target for sources [Begin, End)
+	 * @return Total of the computed distances
+	 */
+	static float ComputeDistances(const float* RESTRICT LocX, const float* RESTRICT LocY, const float* RESTRICT LocZ,
+		const FVector3f& Target, bool bDistanceXY, float* RESTRICT OutDistances, int32 Begin, int32 End);
+
+	/**
+	 * Compute the distance to the target for slots [Begin, End) in the pool
+	 * @return Total of the computed distances
+	 */
+	static float ComputeDistances(FDistanceBlendPool& Pool, const FVector3f& Target, bool bDistanceXY, int32 Begin, int32 End)
+	{
+		return ComputeDistances(Pool.LocationX.GetData(), Pool.LocationY.GetData(), Pool.LocationZ.GetData(), Target, bDistanceXY,
+			Pool.Distances.GetData(), Begin, End);
+	}
+
+	/**
+	 * Compute the distance from slots [Begin, End) in the pool to every target in one pass
+	 * Each source location is loaded once and tested against all targets
+	 * @param OutDistances Per target distance array, indexed by slot
+	 * @param OutTotals Per target total of the computed distances
+	 */
+	static void ComputeDistanceMatrix(const FDistanceBlendPool& Pool, TConstArrayView<FVector3f> Targets, bool bDistanceXY,
+		float* const* OutDistances, float* OutTotals, int32 Begin, int32 End);
+
+	/**
+	 * Set the BlendWeight for slots [Begin, End) from the policy's bias and runtime scaling
+	 * Dividing by the lowest weight prior to normalizing cancels out, so no min-reduction is required
+	 * Instantiated for FInverseDistance, FInverseSquare, FRadiusFalloff and FCurve
+	 * @return Total of the computed weights
+	 */
+	template<typename PolicyType>
+	static float ComputeBiasedWeights(const PolicyType& Policy, const float* RESTRICT Scalars, const float* RESTRICT Distances,
+		float* RESTRICT Biases, float* RESTRICT Weights, int32 Begin, int32 End);
+
+	/** Scale weights for slots [Begin, End) so all weights total 1.0 */
+	static void NormalizeWeights(float* RESTRICT Weights, float Sum, int32 Begin, int32 End);
+
+	/**
+	 * Compute the distance to the target for every slot in the pool
+	 * @return Total of all distances
+	 */
+	static float ComputeDistances(FDistanceBlendPool& Pool, const FVector3f& Target, bool bDistanceXY, const FBatches& Batches);
+
+	/**
+	 * Compute the distance from every slot in the pool to every target
+	 * Totals are reduced per batch then summed in batch order for each target
+	 */
+	static void ComputeDistanceMatrix(const FDistanceBlendPool& Pool, TConstArrayView<FVector3f> Targets, bool bDistanceXY,
+		float* const* OutDistances, float* OutTotals, const FBatches& Batches);
+
+	/**
+	 * Compute bias and normalized weight for Num entries from already computed distances
+	 * The weighting policy is resolved once, then the matching kernel runs for every batch
+	 * @return Sum used for normalization, entries are left at zero if this is not positive
+	 */
+	static float ComputeWeights(const float* Scalars, const float* Distances, float* Biases, float* Weights, int32 Num,
+		float TotalDistances, const FBatches& Batches, const FWeighting& Weighting = FWeighting());
+
+	/**
+	 * Compute bias and normalized weight for every slot in the pool from already computed distances
+	 * @return Sum used for normalization, entries are left at zero if this is not positive
+	 */
+	static float ComputeWeights(FDistanceBlendPool& Pool, float TotalDistances, const FBatches& Batches,
+		const FWeighting& Weighting = FWeighting());
+
+	/**
+	 * Partially order Indices so the first K reference the smallest Distances, then sort those K ascending
+	 * Ties resolve to the lower index so selection is deterministic
+	 */
+	static void SelectNearest(TArrayView<int32> Indices, const float* Distances, int32 K);
+
+	/**
+	 * Weight only the nearest MaxInfluencers of Num entries from already computed distances, every other entry receives zero
+	 * Allocation free, the selected entries are weighted in place
+	 * @param Order Scratch index storage of at least Num entries
+	 */
+	static void ComputeNearestWeights(const float* Scalars, const float* Distances, float* Biases, float* Weights,
+		int32 Num, int32 MaxInfluencers, TArrayView<int32> Order, const FWeighting& Weighting = FWeighting());
+
+private:
+	static constexpr int32 VectorWidth = 4;
+
+	/** Construct the policy selected by Weighting and invoke Fn(Policy) with it */
+	template<typename FuncType>
+	static float VisitWeighting(const FWeighting& Weighting, float AverageDistances, FuncType&& Fn);
+
+	/** Deterministic horizontal add, lanes are always summed in the same order */
+	static float HorizontalSum(const VectorRegister4Float& V);
+};
@@ -0,0 +1,70 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FDistanceBlendPool;
+
+/**
+ * Uniform 2D grid bucketing pool slots by location for relevance culling
+ * Slots without a relevance radius are always considered relevant and are kept outside of the grid
+ * Mirrors the pool's slot layout, so must be kept in sync with FDistanceBlendPool::AddSlot and RemoveSlotAtSwap
+ */
+struct WORLDDISTANCEBLEND_API FDistanceBlendSpatialGrid
+{
+	/** Clear all slots and size the cells, CellSize should be close to the typical relevance radius */
+	void Reset(float InCellSize);
+
+	/** Add the next slot; Radius <= 0 is always relevant */
+	void AddSlot(int32 Slot, const FVector3f& Location, float Radius);
+
+	/** Move a slot to the cell containing its new location */
+	void UpdateSlot(int32 Slot, const FVector3f& Location);
+
+	/** Remove a slot by moving the last slot into it, matching FDistanceBlendPool::RemoveSlotAtSwap */
+	void RemoveSlotAtSwap(int32 Slot);
+
+	/**
+	 * Gather every slot whose relevance radius contains the target
+	 * @param OutSlots Reset then filled with relevant slots
+	 */
+	void Query(const FDistanceBlendPool& Pool, const FVector3f& Target, bool bDistanceXY, TArray<int32>& OutSlots) const;
+
+	int32 Num() const { return SlotRadii.Num(); }
+
+	/** Reserve per slot storage for the expected number of slots, buckets still grow as cells are populated */
+	void Reserve(int32 Capacity);
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	FIntPoint GetCell(const FVector3f& Location) const
+	{
+		return FIntPoint(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize));
+	}
+
+	TArray<int32>& GetBucket(int32 Slot)
+	{
+		return SlotRadii[Slot] > 0.f ? Cells.FindChecked(SlotCells[Slot]) : Unbounded;
+	}
+
+	void AddToBucket(int32 Slot);
+	void RemoveFromBucket(int32 Slot);
+
+	float CellSize = 5000.f;
+
+	/** Largest relevance radius ever added, the query extent */
+	float MaxRadius = 0.f;
+
+	/** Slots bucketed by the cell containing them */
+	TMap<FIntPoint, TArray<int32>> Cells;
+
+	/** Slots with no relevance radius */
+	TArray<int32> Unbounded;
+
+	/** Per slot cell and index within its bucket, for O(1) removal */
+	TArray<FIntPoint> SlotCells;
+	TArray<int32> SlotBucketIndices;
+	TArray<float> SlotRadii;
+};
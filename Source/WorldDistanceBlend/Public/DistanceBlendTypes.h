@@ -5,23 +5,88 @@
 #include "CoreMinimal.h"
 #include "DistanceBlendTypes.generated.h"
 
+class AActor;
+class UCurveFloat;
 class UDistanceBlendComponent;
+class USceneComponent;
 
+/** Whether a blend source can move after it has been registered */
+UENUM(BlueprintType)
+enum class EDistanceBlendMobility : uint8
+{
+	/** Location is captured once at registration */
+	Static,
+	/** Location is pushed to the subsystem whenever the owner's root component moves */
+	Movable,
+};
+
+UENUM(BlueprintType)
+enum class EDistanceBlendWeighting : uint8
+{
+	/** Bias is the average distance divided by the source's distance */
+	InverseDistance,
+	/** Bias is the square of InverseDistance, favouring nearer sources more strongly */
+	InverseSquare,
+	/** Bias falls off linearly from 1 at the target to 0 at FalloffRadius, sources beyond it receive zero */
+	RadiusFalloff,
+	/** Bias is sampled from a baked WeightingCurves entry, selected automatically for channels that have one */
+	Curve UMETA(Hidden),
+};
+
+/**
+ * Stable reference to a registered blend source or additional blend target
+ * Remains valid while registered, regardless of others being added or removed
+ */
+USTRUCT(BlueprintType)
+struct WORLDDISTANCEBLEND_API FDistanceBlendHandle
+{
+	GENERATED_BODY()
+
+	FDistanceBlendHandle()
+		: Index(INDEX_NONE)
+		, Serial(0)
+	{}
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+	void Reset() { *this = FDistanceBlendHandle(); }
+
+	bool operator==(const FDistanceBlendHandle& Other) const { return Index == Other.Index && Serial == Other.Serial; }
+	bool operator!=(const FDistanceBlendHandle& Other) const { return !(*this == Other); }
+
+	friend uint32 GetTypeHash(const FDistanceBlendHandle& Handle)
+	{
+		return HashCombine(::GetTypeHash(Handle.Index), ::GetTypeHash(Handle.Serial));
+	}
+
+	UPROPERTY()
+	int32 Index;
+
+	UPROPERTY()
+	uint32 Serial;
+};
+
+/**
+ * Result for a single source, plain data so arrays of it are never walked by garbage collection
+ * Resolve the source with UWorldDistanceBlendSubsystem::GetBlendWeightComponent()
+ */
 USTRUCT(BlueprintType)
 struct FDistanceBlendWeight
 {
 	GENERATED_BODY()
 
-	FDistanceBlendWeight(UDistanceBlendComponent* InComponent = nullptr)
-		: Component(InComponent)
+	FDistanceBlendWeight(int32 InSlot = INDEX_NONE)
+		: Slot(InSlot)
 		, BlendWeight(0.f)
 		, DistanceBias(1.f)
-		, Scalar(1.f)
 		, Dist(0.f)
 	{}
 
+	/**
+	 * Index of the source in the component table it was computed from
+	 * Only meaningful until sources are next registered or unregistered
+	 */
 	UPROPERTY(BlueprintReadOnly, Category = DistanceBlend)
-	UDistanceBlendComponent* Component;
+	int32 Slot;
 
 	/** Final computed result, the total of every FDistanceBlendWeight in the TArray is 1.0 */
 	UPROPERTY(BlueprintReadOnly, Category = DistanceBlend)
@@ -34,11 +99,168 @@ struct FDistanceBlendWeight
 	UPROPERTY(BlueprintReadOnly, Category = DistanceBlend)
 	float DistanceBias;
 
-	/** Runtime scaling to factor circumstances (eg. light intensity) */
-	UPROPERTY(BlueprintReadOnly, Category = DistanceBlend)
-	float Scalar;
-
 	/** How far from the target */
 	UPROPERTY(BlueprintReadOnly, Category = DistanceBlend)
 	float Dist;
+};
+
+static_assert(sizeof(FDistanceBlendWeight) <= 16, "FDistanceBlendWeight is copied per source per update, keep it small");
+
+/**
+ * Distance to bias response baked from a UCurveFloat into evenly spaced samples
+ * Sampled with linear interpolation instead of evaluating the rich curve per source
+ */
+struct WORLDDISTANCEBLEND_API FDistanceBlendCurveTable
+{
+	static constexpr int32 NumSamples = 256;
+
+	/** Sample the curve across its time range, negative values are clamped to zero */
+	void Bake(const UCurveFloat* Curve);
+
+	void Reset();
+
+	bool IsValid() const { return !Samples.IsEmpty(); }
+
+	SIZE_T GetAllocatedSize() const { return Samples.GetAllocatedSize(); }
+
+	/** Linearly interpolated bias at Dist, clamped to the baked range */
+	float Sample(float Dist) const
+	{
+		const float T = FMath::Clamp((Dist - MinDistance) * InvStep, 0.f, static_cast<float>(NumSamples - 1));
+		const int32 Index = FMath::FloorToInt32(T);
+		return FMath::Lerp(Samples[Index], Samples[Index + 1], T - Index);
+	}
+
+	/** NumSamples entries followed by a copy of the last, so interpolation never reads past the end */
+	TArray<float> Samples;
+
+	float MinDistance = 0.f;
+	float InvStep = 0.f;
+};
+
+/**
+ * Packed per slot floats, cache line aligned so that batches of FDistanceBlendSolver::FBatches::Alignment slots
+ * written by different threads never share a cache line
+ */
+using FDistanceBlendFloatArray = TArray<float, TAlignedHeapAllocator<PLATFORM_CACHE_LINE_SIZE>>;
+
+/**
+ * Persistent structure-of-arrays storage for every source registered with a subsystem
+ * Each array is indexed by the slot assigned when the source is registered
+ * Arrays are updated in place and never shrink, so once warmed up no allocations occur
+ */
+struct WORLDDISTANCEBLEND_API FDistanceBlendPool
+{
+	FDistanceBlendFloatArray LocationX;
+	FDistanceBlendFloatArray LocationY;
+	FDistanceBlendFloatArray LocationZ;
+	FDistanceBlendFloatArray Scalars;
+	FDistanceBlendFloatArray Distances;
+	FDistanceBlendFloatArray DistanceBiases;
+	FDistanceBlendFloatArray BlendWeights;
+
+	/** Weights as last published when interpolating toward BlendWeights, start at zero so new sources fade in */
+	FDistanceBlendFloatArray SmoothedWeights;
+
+	int32 Num() const { return Scalars.Num(); }
+
+	/** Append a slot with default values, returns the slot index */
+	int32 AddSlot();
+
+	/** Remove a slot by moving the last slot into it; the caller is responsible for re-indexing the moved slot */
+	void RemoveSlotAtSwap(int32 Slot);
+
+	/** Reserve storage for the expected number of slots */
+	void Reserve(int32 Capacity);
+
+	/** Resize every array without releasing allocations, used by scratch pools */
+	void SetNum(int32 NewNum);
+
+	SIZE_T GetAllocatedSize() const;
+};
+
+/**
+ * Resolves the location that distance calculations are based on
+ * The accessor is chosen once when the target is assigned, so finding the target each update is a single call
+ */
+struct WORLDDISTANCEBLEND_API FDistanceBlendTargetProvider
+{
+	using FResolveLocation = bool(*)(const FDistanceBlendTargetProvider& Provider, FVector& OutLocation);
+
+	/** Use the actor location, or the camera location if the actor is a PlayerCameraManager */
+	static FDistanceBlendTargetProvider FromActor(const AActor* Actor);
+
+	/** Use the component's world location */
+	static FDistanceBlendTargetProvider FromComponent(const USceneComponent* Component);
+
+	/** Use a fixed world location */
+	static FDistanceBlendTargetProvider FromLocation(const FVector& Location);
+
+	/** @return False if no target is assigned or the target is no longer valid */
+	bool GetLocation(FVector& OutLocation) const
+	{
+		return Resolve && Resolve(*this, OutLocation);
+	}
+
+	bool IsSet() const { return Resolve != nullptr; }
+	const UObject* GetSource() const { return Source.Get(); }
+
+	bool operator==(const FDistanceBlendTargetProvider& Other) const
+	{
+		return Resolve == Other.Resolve && Source == Other.Source && FixedLocation == Other.FixedLocation;
+	}
+	bool operator!=(const FDistanceBlendTargetProvider& Other) const { return !(*this == Other); }
+
+	/** @return True if both resolve the same kind of target from the same source, fixed locations may differ */
+	bool IsSameTarget(const FDistanceBlendTargetProvider& Other) const
+	{
+		return Resolve == Other.Resolve && Source == Other.Source;
+	}
+
+private:
+	TWeakObjectPtr<const UObject> Source;
+	FVector FixedLocation = FVector::ZeroVector;
+	FResolveLocation Resolve = nullptr;
+};
+
+/**
+ * Free-list of stable handles mapping to dense slots
+ * Slots move when other slots are removed with swap-and-pop, handles do not
+ */
+struct WORLDDISTANCEBLEND_API FDistanceBlendHandleTable
+{
+	/** Allocate a handle referencing Slot, reusing a freed entry if available */
+	FDistanceBlendHandle Allocate(int32 Slot);
+
+	/** Release a handle, any copies of it become stale */
+	void Free(const FDistanceBlendHandle& Handle);
+
+	/** @return Slot referenced by Handle, or INDEX_NONE if the handle is stale */
+	int32 GetSlot(const FDistanceBlendHandle& Handle) const
+	{
+		return Entries.IsValidIndex(Handle.Index) && Entries[Handle.Index].Serial == Handle.Serial
+			? Entries[Handle.Index].Slot : INDEX_NONE;
+	}
+
+	/** Point a live handle at the slot it was moved to */
+	void SetSlot(const FDistanceBlendHandle& Handle, int32 Slot)
+	{
+		checkSlow(GetSlot(Handle) != INDEX_NONE);
+		Entries[Handle.Index].Slot = Slot;
+	}
+
+	void Reserve(int32 Capacity) { Entries.Reserve(Capacity); }
+
+	SIZE_T GetAllocatedSize() const { return Entries.GetAllocatedSize() + FreeIndices.GetAllocatedSize(); }
+
+private:
+	struct FEntry
+	{
+		int32 Slot = INDEX_NONE;
+		/** Starts at 1 so a default constructed handle never resolves */
+		uint32 Serial = 1;
+	};
+
+	TArray<FEntry> Entries;
+	TArray<int32> FreeIndices;
 };
\ No newline at end of file
@@ -0,0 +1,28 @@
+﻿// Copyright (c) Jared Taylor. All Rights Reserved
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "WorldDistanceBlendSettings.generated.h"
+
+/**
+ * Project wide memory budget for every UWorldDistanceBlendSubsystem
+ * Override per platform in that platform's Game ini, eg. Config/Switch/SwitchGame.ini
+ */
+UCLASS(Config = Game, DefaultConfig, meta = (DisplayName = "World Distance Blend"))
+class WORLDDISTANCEBLEND_API UWorldDistanceBlendSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+	UWorldDistanceBlendSettings(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+
+	/**
+	 * Sources each subsystem reserves storage for when its world initializes, so registering up to this many never
+	 * reallocates. Storage is never released while the world is alive, so this is also the expected steady state
+	 * Only applies to the default channel, 0 reserves nothing
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = DistanceBlend, meta = (UIMin = "0", ClampMin = "0"))
+	int32 PreallocateCapacity = 0;
+};
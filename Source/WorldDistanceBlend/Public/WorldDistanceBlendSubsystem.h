@@ -3,15 +3,130 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "DistanceBlendClusterTree.h"
 #include "DistanceBlendComponent.h"
+#include "DistanceBlendSolver.h"
+#include "DistanceBlendSpatialGrid.h"
 #include "DistanceBlendTypes.h"
+#include "Engine/EngineTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tasks/Task.h"
 #include "WorldDistanceBlendSubsystem.generated.h"
 
+class UCurveBase;
+
+/** Broadcast once each time a channel's weights are published, the view is valid until the next update */
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnDistanceBlendWeightsUpdated, FName /* Channel */, TConstArrayView<FDistanceBlendWeight> /* Weights */);
+
+class ADistanceBlendReplicator;
+class AController;
+class AGameModeBase;
+class APlayerController;
+class UCurveFloat;
+class USceneComponent;
+struct FDistanceBlendReplicatedWeight;
+
+/**
+ * Additional target evaluated alongside the primary BlendTarget, eg. for split-screen or per-listener weights
+ * Every additional target shares one distance pass over the packed sources
+ */
+struct FDistanceBlendTarget
+{
+	FDistanceBlendHandle Handle;
+	FDistanceBlendTargetProvider Provider;
+
+	/** Location weights were last computed for */
+	FVector3f LastComputedLocation = FVector3f::ZeroVector;
+
+	/** Per slot results, sized to the registered component count */
+	FDistanceBlendFloatArray Distances;
+	FDistanceBlendFloatArray DistanceBiases;
+	FDistanceBlendFloatArray BlendWeights;
+
+	/** Blueprint facing view of the results */
+	TArray<FDistanceBlendWeight> Weights;
+	bool bValid = false;
+};
+
+/**
+ * Called with only the weights that moved by more than the subscription's tolerance since they were last notified
+ * The view is valid for the duration of the call
+ */
+DECLARE_DELEGATE_TwoParams(FOnDistanceBlendWeightsChanged, FName /* Channel */, TConstArrayView<FDistanceBlendWeight> /* Changed */);
+
+/** Listener added by UWorldDistanceBlendSubsystem::SubscribeBlendWeightChanges() */
+struct FDistanceBlendSubscription
+{
+	FDistanceBlendHandle Handle;
+	FName Channel;
+	float Tolerance = 0.f;
+	FOnDistanceBlendWeightsChanged Callback;
+
+	/** Weight each slot had when last notified, slots past the end are treated as zero */
+	TArray<float> NotifiedWeights;
+
+	/** Unsubscribed from within a callback, removed once notification completes */
+	bool bPendingRemoval = false;
+};
+
+/**
+ * Components sharing a named BlendChannel, normalized only against each other
+ * Evaluated on demand by GetChannelBlendWeights(), so a channel nobody queries costs nothing
+ */
+USTRUCT()
+struct FDistanceBlendChannel
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<UDistanceBlendComponent*> Components;
+
+	/** Packed per-slot data for Components */
+	FDistanceBlendPool Pool;
+
+	/** Maps each component's handle to its current slot within this channel */
+	FDistanceBlendHandleTable Handles;
+
+	/** Handle owning each slot, parallel to Components */
+	TArray<FDistanceBlendHandle> SlotHandles;
+
+	/** Slots whose component has bPullBlendScalar, rebuilt after slots are added or removed */
+	TArray<int32> PullScalarSlots;
+	bool bPullScalarSlotsDirty = false;
+
+	/** Slots whose component has bReceiveBlendWeight, rebuilt after slots are added or removed */
+	TArray<int32> WriteBackSlots;
+	bool bWriteBackSlotsDirty = false;
+
+	/** Blueprint facing view of Pool, parallel to Components */
+	TArray<FDistanceBlendWeight> BlendWeights;
+
+	/** True if the last update evaluated at least one component */
+	bool bBlendWeightsValid = false;
+
+	/** Incremented whenever a source in this channel moves, is added or removed, or changes its scalar */
+	uint32 InputsVersion = 0;
+
+	/** InputsVersion, target location and bDistanceXY weights were last computed for */
+	uint32 ComputedInputsVersion = MAX_uint32;
+	FVector3f ComputedTargetLocation = FVector3f::ZeroVector;
+	bool bComputedDistanceXY = true;
+
+	uint64 LastUpdateFrame = -1;
+
+	void MarkInputsDirty()
+	{
+		// Never wrap onto the never-computed sentinel
+		InputsVersion = (InputsVersion + 1) % MAX_uint32;
+	}
+};
+
 /**
  * Base subsystem for tracking and testing against DistanceBlendComponents
+ * Only ticks when bAsyncPrecompute is enabled
  */
 UCLASS(Abstract)
-class WORLDDISTANCEBLEND_API UWorldDistanceBlendSubsystem : public UWorldSubsystem
+class WORLDDISTANCEBLEND_API UWorldDistanceBlendSubsystem : public UTickableWorldSubsystem
 {
 	GENERATED_BODY()
 
@@ -19,12 +134,354 @@ class WORLDDISTANCEBLEND_API UWorldDistanceBlendSubsystem : public UWorldSubsyst
 	/** static UWorldDistanceBlendSubsystem* Get(const UWorld* const InWorld) { return InWorld ? InWorld->GetSubsystem<UWorldDistanceBlendSubsystem>() : nullptr; } */
 
 protected:
+	/**
+	 * The only garbage collected reference to each source, indexed by slot
+	 * Null for sources registered without a component
+	 */
 	UPROPERTY(BlueprintReadOnly, Category = DistanceBlend)
 	TArray<UDistanceBlendComponent*> BlendComponents;
 
+	/** Packed per-slot data for BlendComponents, slots are resolved from handles through BlendHandles */
+	FDistanceBlendPool Pool;
+
+	/** Maps each component's stable FDistanceBlendHandle to its current slot */
+	FDistanceBlendHandleTable BlendHandles;
+
+	/** Handle owning each slot, parallel to BlendComponents */
+	TArray<FDistanceBlendHandle> SlotHandles;
+
+	/** Slots whose component has bPullBlendScalar, rebuilt after slots are added or removed */
+	TArray<int32> PullScalarSlots;
+	bool bPullScalarSlotsDirty = false;
+
+	/** Slots whose component has bReceiveBlendWeight, rebuilt after slots are added or removed */
+	TArray<int32> WriteBackSlots;
+	bool bWriteBackSlotsDirty = false;
+
+	/**
+	 * How each source's distance is mapped to its weight, applies to every channel and target
+	 * Each option runs its own specialized kernel, there is no per-source dispatch
+	 * Set in the derived class constructor
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = DistanceBlend)
+	EDistanceBlendWeighting Weighting = EDistanceBlendWeighting::InverseDistance;
+
+	/**
+	 * Distance at which RadiusFalloff weighting reaches zero, sources beyond it receive no weight
+	 * Set in the derived class constructor
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = DistanceBlend, meta = (EditCondition = "Weighting == EDistanceBlendWeighting::RadiusFalloff", EditConditionHides, UIMin = "100", ClampMin = "1", ForceUnits = "cm"))
+	float FalloffRadius = 5000.f;
+
+	/**
+	 * Distances are clamped to at least this before weighting, so a source sitting on the target, eg. one carried by
+	 * the player pawn, dominates with a finite weight instead of producing Inf or NaN
+	 * Set in the derived class constructor
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = DistanceBlend, meta = (UIMin = "0.01", ClampMin = "0.01", ForceUnits = "cm"))
+	float MinWeightingDistance = 1.f;
+
+	/**
+	 * Designer authored distance to weight response per BlendChannel, None is the default channel
+	 * Channels with a curve use it in place of Weighting. Each curve is baked into a lookup table on initialize
+	 * and rebaked when the asset is edited
+	 * Set in the derived class constructor
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = DistanceBlend)
+	TMap<FName, UCurveFloat*> WeightingCurves;
+
+	/** Baked WeightingCurves, keyed by BlendChannel */
+	TMap<FName, FDistanceBlendCurveTable> WeightingCurveTables;
+
+	/** Bake every entry in WeightingCurves into WeightingCurveTables */
+	void BakeWeightingCurves();
+
+#if WITH_EDITOR
+	void OnWeightingCurveUpdated(UCurveBase* Curve, EPropertyChangeType::Type ChangeType);
+#endif
+
+	/** Solver parameters for a channel, None is the default channel */
+	FDistanceBlendSolver::FWeighting GetWeighting(FName ChannelName = NAME_None) const
+	{
+		if (const FDistanceBlendCurveTable* Curve = WeightingCurveTables.Find(ChannelName))
+		{
+			return { EDistanceBlendWeighting::Curve, FalloffRadius, Curve, MinWeightingDistance };
+		}
+		return { Weighting, FalloffRadius, nullptr, MinWeightingDistance };
+	}
+
+	/**
+	 * If true, components are bucketed in a spatial grid and only those within their MaxRelevanceRadius
+	 * of the target are evaluated. Set in the derived class constructor
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = DistanceBlend)
+	bool bUseSpatialIndex = false;
+
+	/** Grid cell size, should be close to the typical MaxRelevanceRadius */
+	UPROPERTY(EditDefaultsOnly, Category = DistanceBlend, meta = (EditCondition = "bUseSpatialIndex", UIMin = "100", ClampMin = "1", ForceUnits = "cm"))
+	float SpatialIndexCellSize = 5000.f;
+
+	/** Relevance culling for Pool, only maintained when bUseSpatialIndex */
+	FDistanceBlendSpatialGrid SpatialGrid;
+
+	/**
+	 * If above zero, only the nearest MaxInfluencers components are weighted and normalized, the rest receive zero
+	 * Set in the derived class constructor
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = DistanceBlend, meta = (UIMin = "0", ClampMin = "0"))
+	int32 MaxInfluencers = 0;
+
+	/**
+	 * Component counts at or above this are evaluated with ParallelFor, 0 never runs in parallel
+	 * Set in the derived class constructor
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = DistanceBlend, meta = (UIMin = "0", ClampMin = "0"))
+	int32 ParallelThreshold = 8192;
+
+	/**
+	 * Components processed per parallel batch, rounded up to a multiple of 16
+	 * Results depend only on this value, never on thread count
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = DistanceBlend, meta = (UIMin = "16", ClampMin = "16"))
+	int32 ParallelBatchSize = 2048;
+
+	/**
+	 * If above zero, far away groups of components are weighted as one aggregated source, Barnes-Hut style
+	 * A cluster is aggregated once its size is less than this times its distance, so larger values aggregate more
+	 * and 0.5 is typical. Only used for the default channel when neither bUseSpatialIndex nor MaxInfluencers apply
+	 * The hierarchy is rebuilt whenever a source moves, so this suits large stationary far fields
+	 * Set in the derived class constructor
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = DistanceBlend, meta = (UIMin = "0", ClampMin = "0", UIMax = "2"))
+	float ClusterOpeningAngle = 0.f;
+
+	/** Cluster hierarchy over Pool, only maintained when ClusterOpeningAngle is above zero */
+	FDistanceBlendClusterTree ClusterTree;
+
+	/** Sources and clusters evaluated by the last clustered update, see FDistanceBlendClusterTree::Gather() */
+	TArray<int32> ClusterEntries;
+
+	/** Slots weighted by the last selective update (culled or limited by MaxInfluencers) */
+	TArray<int32> InfluencerSlots;
+
+	/** Slots weighted by the previous selective update, cleared if they no longer influence */
+	TArray<int32> PreviousInfluencerSlots;
+
+	/** Scratch storage candidates are gathered into for evaluation */
+	FDistanceBlendPool WorkPool;
+
+	/** Scratch ordering for partial selection of the nearest candidates */
+	TArray<int32> SelectionOrder;
+
+	/** Slots were added or removed since the last selective update, so PreviousInfluencerSlots is stale */
+	bool bInfluencerSlotsStale = true;
+
+	/** The last compute was selective, so only InfluencerSlots and PreviousInfluencerSlots need publishing */
+	bool bComputedSelective = false;
+
+	/** The last selective compute cleared every slot, so publishing must clear the whole view */
+	bool bClearAllOnPublish = false;
+
+	/**
+	 * If true, weights are computed on a task launched when the subsystem ticks, after cameras have updated
+	 * GetBlendWeights() then waits on the (usually completed) task instead of computing on first call
+	 * Set in the derived class constructor
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = DistanceBlend)
+	bool bAsyncPrecompute = false;
+
+	/** bDistanceXY used by async precompute, GetBlendWeights() parameter is ignored when precomputed */
+	UPROPERTY(EditDefaultsOnly, Category = DistanceBlend, meta = (EditCondition = "bAsyncPrecompute"))
+	bool bPrecomputeDistanceXY = true;
+
+	/** In-flight async precompute, completed by CompletePrecompute() */
+	UE::Tasks::FTask PrecomputeTask;
+
+	/** Result of the in-flight async precompute */
+	bool bPrecomputeEvaluated = false;
+
+	/**
+	 * Tick found nothing changed since weights were last computed, so instead of launching a precompute the current
+	 * weights are this frame's. Consumed by the next GetBlendWeights() like a precompute, cleared if inputs change
+	 */
+	bool bPrecomputeReused = false;
+
+	/**
+	 * If the target moved less than this since weights were last computed, and no source moved, registered
+	 * or changed its scalar, the previous weights are reused without recomputing or writing back
+	 * Set in the derived class constructor
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = DistanceBlend, meta = (UIMin = "0", ClampMin = "0", ForceUnits = "cm"))
+	float TargetMovedTolerance = 0.f;
+
+	/** Incremented whenever a source moves, is added or removed, changes its scalar, or the target is reassigned */
+	uint32 BlendInputsVersion = 0;
+
+	/** BlendInputsVersion weights were last computed for */
+	uint32 LastComputedInputsVersion = MAX_uint32;
+
+	void MarkBlendInputsDirty()
+	{
+		// Never wrap onto the never-computed sentinel
+		BlendInputsVersion = (BlendInputsVersion + 1) % MAX_uint32;
+		ClusterTree.MarkScalarsDirty();
+		bPrecomputeReused = false;
+	}
+
+	/**
+	 * Minimum time between weight computations, in between the last computed weights are returned or interpolated toward
+	 * 0 computes whenever requested. Set in the derived class constructor
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = DistanceBlend, meta = (UIMin = "0", ClampMin = "0", ForceUnits = "s"))
+	float UpdateInterval = 0.f;
+
+	/**
+	 * If above zero, published weights interpolate toward the computed weights at this speed instead of snapping
+	 * The first valid set is published as computed, after which newly registered components fade in from zero
+	 * While interpolating, each frame visits every slot with a nonzero computed or published weight, or every slot
+	 * after a full (not culled or MaxInfluencers limited) update. Set in the derived class constructor
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = DistanceBlend, meta = (UIMin = "0", ClampMin = "0"))
+	float BlendWeightInterpSpeed = 0.f;
+
+	/**
+	 * If above zero, distances are gathered over as many frames as needed, spending at most this long each frame
+	 * Weights are only normalized and published once a full sweep completes, so GetBlendWeights() always returns
+	 * the last complete set. The spatial index and async precompute are not used while sweeping
+	 * Set in the derived class constructor
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = DistanceBlend, meta = (UIMin = "0", ClampMin = "0", ForceUnits = "us"))
+	float SweepBudgetMicroseconds = 0.f;
+
+	/** Components gathered between budget checks, rounded up to a multiple of 16 */
+	UPROPERTY(EditDefaultsOnly, Category = DistanceBlend, meta = (EditCondition = "SweepBudgetMicroseconds > 0", UIMin = "16", ClampMin = "16"))
+	int32 SweepChunkSize = 1024;
+
+	/** Next slot the sweep will gather, INDEX_NONE while no sweep is in progress */
+	int32 SweepCursor = INDEX_NONE;
+
+	/** Inputs the sweep in progress was started with, held for the whole sweep so the result is consistent */
+	FVector3f SweepTargetLocation = FVector3f::ZeroVector;
+	bool bSweepDistanceXY = true;
+	uint32 SweepInputsVersion = MAX_uint32;
+
+	/** Distances gathered by the sweep in progress, swapped into Pool when it completes */
+	FDistanceBlendFloatArray SweepDistances;
+	float SweepTotalDistances = 0.f;
+
+	/** When and over how many frames the sweep in progress has run */
+	double SweepStartTime = 0.0;
+	int32 SweepFrames = 0;
+
+	/** Seconds and frames between starting and completing the last sweep */
+	float LastSweepLatency = 0.f;
+	int32 LastSweepFrames = 0;
+
+	/** Abandon the sweep in progress, required whenever slots are added, removed or the target changes */
+	void RestartSweep()
+	{
+		SweepCursor = INDEX_NONE;
+	}
+
+	/** World time weights were last computed */
+	double LastComputeTime = 0.0;
+
+	/** Published weights have not yet reached the computed weights */
+	bool bInterpolatingBlendWeights = false;
+
+	/** Frame published weights were last interpolated */
+	uint64 LastInterpolatedFrame = -1;
+
+	/** SmoothedWeights were seeded from a valid computed set, cleared when the last slot is removed */
+	bool bSmoothedWeightsSeeded = false;
+
+	/** A slot was removed, dropping its smoothed weight, so the remainder must be rescaled to total 1.0 */
+	bool bRenormalizeSmoothedWeights = false;
+
+	/** Every slot with a nonzero smoothed weight, so selective updates only interpolate the slots that can change */
+	TArray<int32> SmoothedSlots;
+
+	/** Scratch for the previous frame's SmoothedSlots */
+	TArray<int32> PreviousSmoothedSlots;
+
+	/** SmoothedSlots no longer matches the pool, the next interpolation visits every slot to rebuild it */
+	bool bSmoothedSlotsStale = false;
+
+	/** @return True if weights were computed less than UpdateInterval ago and are still valid */
+	bool IsWithinUpdateInterval() const;
+
+	/** Target location weights were last computed for */
+	FVector3f LastComputedTargetLocation = FVector3f::ZeroVector;
+
+	/** bDistanceXY weights were last computed for */
+	bool bLastComputedDistanceXY = true;
+
 	UPROPERTY()
 	uint64 LastUpdateFrame = -1;
 
+	/** Components with a BlendChannel other than None, which never share normalization with the default channel */
+	UPROPERTY()
+	TMap<FName, FDistanceBlendChannel> BlendChannels;
+
+	/** Additional targets, see AddBlendTarget() */
+	TArray<FDistanceBlendTarget> BlendTargets;
+
+	/** Maps each additional target's handle to its index in BlendTargets */
+	FDistanceBlendHandleTable BlendTargetHandles;
+
+	/** Listeners added by SubscribeBlendWeightChanges() */
+	TArray<FDistanceBlendSubscription> Subscriptions;
+
+	/** Maps each subscription's handle to its index in Subscriptions */
+	FDistanceBlendHandleTable SubscriptionHandles;
+
+	/** Subscriptions are being notified, so unsubscribing is deferred */
+	bool bNotifyingSubscriptions = false;
+
+	/** Frame additional targets were last updated */
+	uint64 TargetsLastUpdateFrame = -1;
+
+	/** BlendInputsVersion additional targets were last computed for */
+	uint32 TargetsComputedInputsVersion = MAX_uint32;
+
+	/** bDistanceXY additional targets were last computed for */
+	bool bTargetsComputedDistanceXY = true;
+
+	/**
+	 * If set, the server evaluates the default channel for each remote PlayerController through an instance of this
+	 * class, and replicates the strongest quantized weights to that client only
+	 * Clients then apply the replicated weights instead of computing their own, see UsesReplicatedBlendWeights()
+	 * Set in the derived class constructor
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = DistanceBlend)
+	TSubclassOf<ADistanceBlendReplicator> ReplicatorClass;
+
+	/** Server only, the replicator spawned for each remote PlayerController */
+	UPROPERTY()
+	TMap<APlayerController*, ADistanceBlendReplicator*> Replicators;
+
+	FDelegateHandle PostLoginHandle;
+	FDelegateHandle LogoutHandle;
+
+	void OnPostLogin(AGameModeBase* GameMode, APlayerController* PlayerController);
+	void OnLogout(AGameModeBase* GameMode, AController* Controller);
+
+	/** Server only, spawn a replicator for a remote PlayerController if it doesn't have one */
+	void AddReplicator(APlayerController* PlayerController);
+
+	/** Scratch storage for the batched multi-target pass, inline so typical target counts never allocate */
+	TArray<FVector3f, TInlineAllocator<4>> TargetLocationScratch;
+	TArray<float*, TInlineAllocator<4>> TargetDistanceScratch;
+	TArray<float, TInlineAllocator<4>> TargetTotalScratch;
+
+	/** Highest GetAllocatedSize() seen, sampled whenever weights are published */
+	SIZE_T PeakAllocatedSize = 0;
+
+	void UpdatePeakAllocatedSize()
+	{
+		PeakAllocatedSize = FMath::Max(PeakAllocatedSize, GetAllocatedSize());
+	}
+
 	bool ShouldUpdateDistance() const
 	{
 		return GFrameCounter != LastUpdateFrame;
@@ -33,20 +490,72 @@ protected:
 	/**
 	 * The actor that the distance calculations are based on
 	 * Passing a PlayerCameraManager will use the camera location instead
+	 * Null if the target was assigned as a component or location
 	 */
 	TWeakObjectPtr<AActor> BlendTarget;
+
+	/** Resolves the target location, bound when the target is assigned */
+	FDistanceBlendTargetProvider BlendTargetProvider;
+
+	void AssignBlendTargetProvider(const FDistanceBlendTargetProvider& NewProvider)
+	{
+		// A new fixed location is only target movement, handled by the same reuse checks as a moving actor
+		if (!NewProvider.IsSameTarget(BlendTargetProvider))
+		{
+			CompletePrecompute();
+			RetainLastValidBlendWeights();
+			BlendWeights.Reset();
+			bInfluencerSlotsStale = true;
+			MarkBlendInputsDirty();
+			RestartSweep();
+			bBlendWeightsValid = false;
+			LastUpdateFrame = -1;
+			for (TPair<FName, FDistanceBlendChannel>& Channel : BlendChannels)
+			{
+				Channel.Value.MarkInputsDirty();
+				Channel.Value.LastUpdateFrame = -1;
+			}
+		}
+		BlendTargetProvider = NewProvider;
+	}
 	
-	UPROPERTY()
+	/** Blueprint facing view of Pool, updated in place by GetBlendWeights(), parallel to BlendComponents */
 	TArray<FDistanceBlendWeight> BlendWeights;
 
+	/** True if the last update evaluated at least one component */
+	bool bBlendWeightsValid = false;
+
 	/**
 	 * Last valid blend weights before BlendWeights were cleared
-	 * Still invalid if GetBlendWeights() has never been called
+	 * Swapped with BlendWeights rather than copied, only meaningful while bLastValidIsFront is false
 	 */
-	UPROPERTY()
 	TArray<FDistanceBlendWeight> LastValidBlendWeights;
+
+	/** BlendWeights is itself the last valid set, so LastValidBlendWeights holds nothing of use */
+	bool bLastValidIsFront = false;
+
+	/** BlendWeights holds an older set after a swap, so the next publish must write every slot */
+	bool bBlendWeightsStale = false;
+
+	/** Keep the current weights as the last valid set before they are cleared, by swapping buffers rather than copying */
+	void RetainLastValidBlendWeights()
+	{
+		if (bLastValidIsFront)
+		{
+			Swap(BlendWeights, LastValidBlendWeights);
+			bLastValidIsFront = false;
+			bBlendWeightsStale = true;
+		}
+	}
 	
 public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
 	/**
 	 * Assign the actor that the distance calculations are based on
 	 * Passing a PlayerCameraManager will use the camera location instead
@@ -54,28 +563,288 @@ public:
 	UFUNCTION(BlueprintCallable, Category = DistanceBlend)
 	void AssignBlendTarget(AActor* NewBlendTarget)
 	{
-		if (NewBlendTarget != BlendTarget)
-		{
-			BlendWeights.Empty();
-			LastUpdateFrame = -1;
-		}
 		BlendTarget = NewBlendTarget;
+		AssignBlendTargetProvider(FDistanceBlendTargetProvider::FromActor(NewBlendTarget));
+	}
+
+	/** Assign a scene component that the distance calculations are based on */
+	UFUNCTION(BlueprintCallable, Category = DistanceBlend)
+	void AssignBlendTargetComponent(USceneComponent* NewBlendTarget)
+	{
+		BlendTarget.Reset();
+		AssignBlendTargetProvider(FDistanceBlendTargetProvider::FromComponent(NewBlendTarget));
+	}
+
+	/**
+	 * Assign a fixed world location that the distance calculations are based on
+	 * Can be called every frame to drive the target manually, moving it does not invalidate the current weights
+	 */
+	UFUNCTION(BlueprintCallable, Category = DistanceBlend)
+	void AssignBlendTargetLocation(const FVector& NewBlendTargetLocation)
+	{
+		BlendTarget.Reset();
+		AssignBlendTargetProvider(FDistanceBlendTargetProvider::FromLocation(NewBlendTargetLocation));
 	}
 	
-	/** Register a DistanceBlendComponent */
+	/**
+	 * Add a target evaluated alongside the primary BlendTarget, eg. for split-screen or per-listener weights
+	 * Passing a PlayerCameraManager will use the camera location instead
+	 * @return Handle used to retrieve this target's weights with GetBlendWeightsForTarget()
+	 */
 	UFUNCTION(BlueprintCallable, Category = DistanceBlend)
-	void RegisterBlendComponent(UDistanceBlendComponent* BlendComponent)
+	FDistanceBlendHandle AddBlendTarget(AActor* NewBlendTarget)
 	{
-		BlendComponents.AddUnique(BlendComponent);
+		return AddBlendTargetProvider(FDistanceBlendTargetProvider::FromActor(NewBlendTarget));
 	}
 
+	/** Add a scene component target evaluated alongside the primary BlendTarget */
+	UFUNCTION(BlueprintCallable, Category = DistanceBlend)
+	FDistanceBlendHandle AddBlendTargetComponent(USceneComponent* NewBlendTarget)
+	{
+		return AddBlendTargetProvider(FDistanceBlendTargetProvider::FromComponent(NewBlendTarget));
+	}
+
+	/** Add a target evaluated alongside the primary BlendTarget */
+	FDistanceBlendHandle AddBlendTargetProvider(const FDistanceBlendTargetProvider& Provider);
+
+	/** Remove a target added by AddBlendTarget() */
+	UFUNCTION(BlueprintCallable, Category = DistanceBlend)
+	void RemoveBlendTarget(FDistanceBlendHandle TargetHandle);
+
+	/**
+	 * Be notified when any weight in a channel moves by more than Tolerance, instead of polling every tick
+	 * A weight's baseline only advances when it is notified, so slow drift is still reported once it accumulates
+	 * @param Channel BlendChannel to watch, None is the default channel
+	 * @param Tolerance Change in BlendWeight required to notify, 0 notifies any change
+	 * @return Handle to pass to UnsubscribeBlendWeightChanges()
+	 */
+	FDistanceBlendHandle SubscribeBlendWeightChanges(FName Channel, float Tolerance, FOnDistanceBlendWeightsChanged Callback);
+
+	/** Remove a listener added by SubscribeBlendWeightChanges(), safe to call from within its callback */
+	void UnsubscribeBlendWeightChanges(FDistanceBlendHandle SubscriptionHandle);
+
+	/**
+	 * Register a DistanceBlendComponent
+	 * @return Stable handle, also stored on the component. Returns the existing handle if already registered
+	 */
+	UFUNCTION(BlueprintCallable, Category = DistanceBlend)
+	FDistanceBlendHandle RegisterBlendComponent(UDistanceBlendComponent* BlendComponent);
+
 	/** Deregister a DistanceBlendComponent */
 	UFUNCTION(BlueprintCallable, Category = DistanceBlend)
-	void UnregisterBlendComponent(UDistanceBlendComponent* BlendComponent)
+	void UnregisterBlendComponent(UDistanceBlendComponent* BlendComponent);
+
+	/** Register many DistanceBlendComponents at once, eg. when a streaming cell loads */
+	UFUNCTION(BlueprintCallable, Category = DistanceBlend)
+	void RegisterBlendComponents(const TArray<UDistanceBlendComponent*>& InBlendComponents);
+
+	/** Deregister many DistanceBlendComponents at once, eg. when a streaming cell unloads */
+	UFUNCTION(BlueprintCallable, Category = DistanceBlend)
+	void UnregisterBlendComponents(const TArray<UDistanceBlendComponent*>& InBlendComponents);
+
+	/**
+	 * Reserve storage for the expected number of sources in the default channel, including per-update scratch
+	 * Called on initialize with UWorldDistanceBlendSettings::PreallocateCapacity
+	 */
+	void ReserveBlendSources(int32 Capacity);
+
+	/** Heap memory currently held by this subsystem, excluding the UObject itself */
+	SIZE_T GetAllocatedSize() const;
+
+	/** Highest GetAllocatedSize() seen since initialize, storage is never released so this is usually current */
+	SIZE_T GetPeakAllocatedSize() const { return FMath::Max(PeakAllocatedSize, GetAllocatedSize()); }
+
+#if !UE_BUILD_SHIPPING
+	/** Log source counts and memory, see wdb.Stats */
+	void LogStats() const;
+#endif
+
+	/** @return True if the component is registered with this subsystem */
+	UFUNCTION(BlueprintPure, Category = DistanceBlend)
+	bool IsBlendComponentRegistered(const UDistanceBlendComponent* BlendComponent) const
+	{
+		if (!BlendComponent || BlendComponent->BlendSubsystem.Get() != this)
+		{
+			return false;
+		}
+		if (BlendComponent->RegisteredBlendChannel.IsNone())
+		{
+			const int32 Slot = GetBlendSlot(BlendComponent->BlendHandle);
+			return Slot != INDEX_NONE && BlendComponents[Slot] == BlendComponent;
+		}
+		const FDistanceBlendChannel* Channel = BlendChannels.Find(BlendComponent->RegisteredBlendChannel);
+		const int32 Slot = Channel ? Channel->Handles.GetSlot(BlendComponent->BlendHandle) : INDEX_NONE;
+		return Slot != INDEX_NONE && Channel->Components[Slot] == BlendComponent;
+	}
+
+	/**
+	 * Recapture the location of a registered DistanceBlendComponent
+	 * Only required for Static components that were moved after registration
+	 */
+	UFUNCTION(BlueprintCallable, Category = DistanceBlend)
+	void UpdateBlendComponentLocation(UDistanceBlendComponent* BlendComponent);
+
+	/** Seconds between starting and completing the last time-sliced sweep, see SweepBudgetMicroseconds */
+	UFUNCTION(BlueprintPure, Category = DistanceBlend)
+	float GetLastSweepLatency() const { return LastSweepLatency; }
+
+	/** Frames between starting and completing the last time-sliced sweep, see SweepBudgetMicroseconds */
+	UFUNCTION(BlueprintPure, Category = DistanceBlend)
+	int32 GetLastSweepFrames() const { return LastSweepFrames; }
+
+	/**
+	 * Register a source without an actor or component, eg. a Mass entity
+	 * The source joins the default channel, its location and scalar are only changed by the calls below
+	 * @return Stable handle used to update, read back and unregister the source
+	 */
+	FDistanceBlendHandle RegisterBlendSource(const FVector& Location, float Scalar = 1.f, float MaxRelevanceRadius = 0.f);
+
+	/** Deregister a source added by RegisterBlendSource() */
+	void UnregisterBlendSource(FDistanceBlendHandle Handle);
+
+	/** Push a new location for a source added by RegisterBlendSource() */
+	void SetBlendSourceLocation(FDistanceBlendHandle Handle, const FVector& Location);
+
+	/** Push a new scalar for a source added by RegisterBlendSource() */
+	void SetBlendSourceScalar(FDistanceBlendHandle Handle, float Scalar);
+
+	/** @return Last published weight of a source, 0 if it is not registered or the weights are not valid */
+	float GetBlendSourceWeight(FDistanceBlendHandle Handle) const;
+
+	/**
+	 * @return Current index of a source into GetPackedBlendWeights(), or INDEX_NONE if it is not registered
+	 * Slots move as sources unregister, resolve them again after every update rather than caching them
+	 */
+	int32 GetBlendSourceSlot(FDistanceBlendHandle Handle) const { return GetBlendSlot(Handle); }
+
+	/** Push a new scalar for a registered DistanceBlendComponent, prefer UDistanceBlendComponent::SetBlendScalar() */
+	void SetBlendComponentScalar(UDistanceBlendComponent* BlendComponent, float Scalar);
+
+protected:
+	/** @return Current slot for a handle, or INDEX_NONE if it is not registered with this subsystem */
+	int32 GetBlendSlot(const FDistanceBlendHandle& Handle) const
+	{
+		return BlendHandles.GetSlot(Handle);
+	}
+
+	FDistanceBlendHandle RegisterBlendComponentInternal(UDistanceBlendComponent* BlendComponent);
+	void UnregisterBlendComponentInternal(UDistanceBlendComponent* BlendComponent);
+
+	/** Stop tracking the owner's root transform for a component being unregistered */
+	void UnbindTransformUpdated(UDistanceBlendComponent* BlendComponent);
+
+	/** Append a slot to the default channel, BlendComponent is null for sources registered without one */
+	FDistanceBlendHandle AddBlendSlot(UDistanceBlendComponent* BlendComponent, const FVector& Location, float Scalar,
+		float MaxRelevanceRadius);
+
+	/** Remove a slot from the default channel by swapping the last slot into it */
+	void RemoveBlendSlot(int32 Slot);
+
+	void OnBlendSourceTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags,
+		ETeleportType Teleport, FDistanceBlendHandle Handle);
+
+	FDistanceBlendHandle RegisterChannelBlendComponent(UDistanceBlendComponent* BlendComponent);
+	void UnregisterChannelBlendComponent(UDistanceBlendComponent* BlendComponent);
+
+	void OnChannelBlendSourceTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags,
+		ETeleportType Teleport, FName ChannelName, FDistanceBlendHandle Handle);
+
+	void WriteChannelBlendSourceLocation(FDistanceBlendChannel& Channel, int32 Slot, const FVector& Location);
+
+	/**
+	 * Copy published weights to the components that opted in with bReceiveBlendWeight, then broadcast OnBlendWeightsUpdated
+	 * Components that did not opt in are never written to
+	 */
+	void WriteBackBlendWeights(FName ChannelName, TConstArrayView<FDistanceBlendWeight> Weights,
+		TConstArrayView<UDistanceBlendComponent*> Components, TArray<int32>& InWriteBackSlots, bool& bInWriteBackSlotsDirty);
+
+	/** Notify subscriptions to a channel of every weight that moved beyond their tolerance */
+	void NotifySubscriptions(FName ChannelName, TConstArrayView<FDistanceBlendWeight> Weights);
+
+	/** Mirror a slot being swapped out of a channel in each subscription's baseline */
+	void RemoveSubscriptionSlot(FName ChannelName, int32 Slot, int32 NumSlots);
+
+	void RemoveSubscriptionAt(int32 Index);
+
+	/** Compute and publish weights for a named channel relative to the primary target */
+	void UpdateChannelBlendWeights(FName ChannelName, FDistanceBlendChannel& Channel, bool bDistanceXY);
+
+	void WriteBlendSourceLocation(int32 Slot, const FVector& Location);
+
+	/** @return True if nothing that affects the result changed since weights were last computed, except pulled scalars */
+	bool CanReuseBlendWeights(const FVector3f& TargetLocation, bool bDistanceXY) const
 	{
-		BlendComponents.Remove(BlendComponent);
+		return BlendInputsVersion == LastComputedInputsVersion && bDistanceXY == bLastComputedDistanceXY &&
+			FVector3f::DistSquared(TargetLocation, LastComputedTargetLocation) <= FMath::Square(TargetMovedTolerance);
 	}
 
+	/** Record the inputs weights were computed for, after any scalars were gathered */
+	void MarkBlendWeightsComputed(const FVector3f& TargetLocation, bool bDistanceXY);
+
+	/**
+	 * Call GetBlendScalar() for components with bPullBlendScalar and pack the result, game thread only
+	 * @param bEvaluatedOnly If true only gather for components that were evaluated by the last compute
+	 * @return True if any gathered scalar differs from the packed value, which also marks the inputs dirty
+	 */
+	bool GatherBlendScalars(bool bEvaluatedOnly);
+
+	/**
+	 * Compute weights into Pool without touching the Blueprint facing view or components
+	 * Safe to run off the game thread when bGatherScalars is false
+	 * @param bGatherScalars If true, call GetBlendScalar() for evaluated components with bPullBlendScalar, otherwise only use the packed scalars
+	 * @return True if any slot was evaluated
+	 */
+	bool ComputeBlendWeights(const FVector3f& TargetLocation, bool bDistanceXY, bool bGatherScalars);
+
+	/** Evaluate every slot, @return True if any slot was evaluated */
+	bool ComputeAllBlendWeights(const FVector3f& TargetLocation, bool bDistanceXY, bool bGatherScalars);
+
+	/** Evaluate nearby slots individually and far clusters as aggregates, @return True if any slot was evaluated */
+	bool ComputeClusteredBlendWeights(const FVector3f& TargetLocation, bool bDistanceXY, bool bGatherScalars);
+
+	/**
+	 * Evaluate only the slots relevant to the target, limited to the nearest MaxInfluencers, zeroing the rest
+	 * @return True if any slot was evaluated
+	 */
+	bool ComputeSelectedBlendWeights(const FVector3f& TargetLocation, bool bDistanceXY, bool bGatherScalars);
+
+	/**
+	 * Compute weights for every additional target in one batched pass over the sources
+	 * Additional targets are limited by MaxInfluencers but not culled by the spatial index
+	 */
+	void UpdateTargetBlendWeights(bool bDistanceXY);
+
+	/** Write the last computed weights to the Blueprint facing view and opted in components, game thread only */
+	void PublishBlendWeights(bool bEvaluated);
+
+	/**
+	 * Gather distances for as many slots as SweepBudgetMicroseconds allows, starting a new sweep if needed
+	 * Completing a sweep computes and publishes the weights
+	 */
+	void AdvanceSweep(const FVector3f& TargetLocation, bool bDistanceXY);
+
+	/** Move published weights toward the computed weights once per frame while BlendWeightInterpSpeed is enabled */
+	void InterpolateBlendWeights();
+
+	/** Wait for any in-flight async precompute and publish its result */
+	void CompletePrecompute();
+
+	/** Wait for any in-flight async precompute before mutating Pool, its result is published later */
+	void WaitForPrecompute() const
+	{
+		if (PrecomputeTask.IsValid())
+		{
+			PrecomputeTask.Wait();
+		}
+	}
+
+	/** Copy a slot from Pool into the Blueprint facing view */
+	void WriteBlendWeight(int32 Slot);
+
+	/** Zero a slot in the Blueprint facing view */
+	void ClearBlendWeight(int32 Slot);
+
+public:
 	/**
 	 * Get the last valid blend weights before BlendWeights were cleared
 	 * Still invalid if GetBlendWeights() has never been called (check against bValid)
@@ -84,116 +853,101 @@ public:
 	UFUNCTION(BlueprintCallable, Category = DistanceBlend)
 	const TArray<FDistanceBlendWeight>& GetLastValidBlendWeights(bool& bValid) const
 	{
-		bValid = LastValidBlendWeights.Num() > 0;
-		return LastValidBlendWeights;
+		const TArray<FDistanceBlendWeight>& LastValid = bLastValidIsFront ? BlendWeights : LastValidBlendWeights;
+		bValid = LastValid.Num() > 0;
+		return LastValid;
 	}
 
 	/**
 	 * @param WorldLocation Location to get the distance to each DistanceBlendComponent
 	 * @param bValid True if the blend weights have valid data
-	 * @param bDistanceXY If true only get the distance in 2D Space (ignoring Z axis)
-	 * @return Blend Weights if already updated this frame, otherwise will update then return
+	 * @param bDistanceXY If true only get the distance in 2D Space (ignoring Z axis), ignored if precomputed
+	 * @return Blend Weights if already updated this frame or precomputed, otherwise will update then return
 	 */
 	UFUNCTION(BlueprintCallable, Category = DistanceBlend)
-	const TArray<FDistanceBlendWeight>& GetBlendWeights(bool& bValid, bool bDistanceXY = true) const
+	const TArray<FDistanceBlendWeight>& GetBlendWeights(bool& bValid, bool bDistanceXY = true) const;
+
+	/** Native access to GetBlendWeights() without copying, valid until the next update */
+	TConstArrayView<FDistanceBlendWeight> GetBlendWeightsView(bool& bValid, bool bDistanceXY = true) const
 	{
-		bValid = false;
+		return GetBlendWeights(bValid, bDistanceXY);
+	}
 
-		if (!BlendTarget.IsValid())
-		{
-			return BlendWeights;
-		}
-		
-		// Don't compute new blend weights if already updated this frame
-		if (ShouldUpdateDistance())
-		{
-			// Compute new blend weights
-			UWorldDistanceBlendSubsystem* MutableThis = const_cast<UWorldDistanceBlendSubsystem*>(this);
-			MutableThis->LastUpdateFrame = GFrameCounter;
+	/**
+	 * Native access to the packed weights, indexed by slot and parallel to BlendComponents
+	 * Skips the Blueprint facing view entirely, valid until the next update
+	 * Smoothed the same as GetBlendWeights() while BlendWeightInterpSpeed is enabled
+	 */
+	TConstArrayView<float> GetPackedBlendWeights(bool& bValid, bool bDistanceXY = true) const
+	{
+		// GetBlendWeights() also interpolates the smoothed weights for this frame
+		GetBlendWeights(bValid, bDistanceXY);
+		return BlendWeightInterpSpeed > 0.f ? Pool.SmoothedWeights : Pool.BlendWeights;
+	}
 
-			TArray<FDistanceBlendWeight>& Weights = MutableThis->BlendWeights;
-			Weights.Empty();
+	/**
+	 * Get the weights relative to an additional target added by AddBlendTarget()
+	 * All additional targets are updated together, the first call each frame determines bDistanceXY
+	 * These weights are not written back to the components
+	 * @param TargetHandle Handle returned by AddBlendTarget()
+	 * @param bValid True if the blend weights have valid data
+	 * @param bDistanceXY If true only get the distance in 2D Space (ignoring Z axis)
+	 */
+	UFUNCTION(BlueprintCallable, Category = DistanceBlend)
+	const TArray<FDistanceBlendWeight>& GetBlendWeightsForTarget(FDistanceBlendHandle TargetHandle, bool& bValid, bool bDistanceXY = true) const;
 
-			float TotalDistances = 0.f;
+	/**
+	 * Get the weights of components in a BlendChannel, normalized only against each other
+	 * Evaluated relative to the primary target, limited by MaxInfluencers but not culled by the spatial index
+	 * @param Channel BlendChannel to evaluate, None returns GetBlendWeights()
+	 * @param bValid True if the blend weights have valid data
+	 * @param bDistanceXY If true only get the distance in 2D Space (ignoring Z axis)
+	 * @return Blend Weights if already updated this frame, otherwise will update then return
+	 */
+	UFUNCTION(BlueprintCallable, Category = DistanceBlend)
+	const TArray<FDistanceBlendWeight>& GetChannelBlendWeights(FName Channel, bool& bValid, bool bDistanceXY = true) const;
 
-			// Cache all relevant information about each component
-			for (UDistanceBlendComponent* Comp : BlendComponents)
-			{
-				// Note: Not null checking, components expected to call RegisterBlendComponent and DeregisterBlendComponent
-				// If you crashed here, this is why
-				checkSlow(Comp != nullptr && IsValid(Comp->GetOwner()));
-
-				FDistanceBlendWeight BlendWeight { Comp };
-				
-				const AActor* Owner = Comp->GetOwner();
-				BlendWeight.Scalar = Comp->GetBlendScalar();
-
-				FVector TargetLocation = BlendTarget.Get()->GetActorLocation();
-				if (const APlayerCameraManager* CameraManager = Cast<APlayerCameraManager>(BlendTarget.Get()))
-				{
-					TargetLocation = CameraManager->GetCameraLocation();
-				}
-
-				const FVector Diff = (TargetLocation - Owner->GetActorLocation());
-				BlendWeight.Dist = bDistanceXY ? Diff.Size2D() : Diff.Size();
-
-				TotalDistances += BlendWeight.Dist;
-				
-				Weights.Add(BlendWeight);
-			}
+	/** Last weight published for a registered component in any channel, without triggering an update */
+	FDistanceBlendWeight GetBlendComponentWeight(const UDistanceBlendComponent* BlendComponent) const;
 
-			if (Weights.Num() == 0)
-			{
-				return BlendWeights;
-			}
+	/** @return True on clients when a ReplicatorClass is set, the default channel is then only updated by the server */
+	bool UsesReplicatedBlendWeights() const;
 
-			// Compute biases from gathered information
-			const float AverageDistances = TotalDistances / Weights.Num();
-			for (FDistanceBlendWeight& W : Weights)
-			{
-				// Set the BlendWeight based on relativity to average distance and runtime scaling
-				// This is the precursor BlendWeight prior to averaging based on BlendWeights achieved by
-				// remaining entries within this loop
-				W.DistanceBias = AverageDistances / W.Dist;
-				W.BlendWeight = W.DistanceBias * W.Scalar;
-			}
+	/**
+	 * Replace the default channel's weights with those received from the server, every other source receives zero
+	 * Published, interpolated and written back exactly as if they had been computed locally
+	 * Components that are not registered on this client are ignored
+	 */
+	void ApplyReplicatedBlendWeights(TConstArrayView<FDistanceBlendReplicatedWeight> ReplicatedWeights);
 
-			// Scale the bias relative to each entry to achieve the final result
-			{
-				float Lowest = INFINITY;
-				float Sum = 0.f;
-
-				for (const FDistanceBlendWeight& W : Weights)
-				{
-					// Find lowest weight
-					if (W.BlendWeight < Lowest)
-					{
-						Lowest = W.BlendWeight;
-					}
-				}
-
-				// Divide by lowest and compute sum
-				for (FDistanceBlendWeight& W : Weights)
-				{
-					W.BlendWeight /= Lowest;
-					Sum += W.BlendWeight;
-				}
-
-				// Scale array to become 1.0
-				for (FDistanceBlendWeight& W : Weights)
-				{
-					W.BlendWeight /= Sum;
-					W.Component->BlendWeight = W;
-				}
-			}
+	/**
+	 * Broadcast once per publish with every weight in the channel, instead of writing to each component
+	 * Also broadcast each frame the default channel interpolates towards new weights
+	 */
+	FOnDistanceBlendWeightsUpdated OnBlendWeightsUpdated;
 
-			if (BlendWeights.Num() > 0)
-			{
-				MutableThis->LastValidBlendWeights = BlendWeights;
-			}
-		}
+	/**
+	 * Resolve the component a weight from GetBlendWeights() or GetBlendWeightsForTarget() was computed for
+	 * @return Null for sources registered without a component, or if the slot no longer exists
+	 */
+	UFUNCTION(BlueprintPure, Category = DistanceBlend)
+	UDistanceBlendComponent* GetBlendWeightComponent(const FDistanceBlendWeight& Weight) const
+	{
+		return BlendComponents.IsValidIndex(Weight.Slot) ? BlendComponents[Weight.Slot] : nullptr;
+	}
 
-		bValid = BlendWeights.Num() > 0;
-		return BlendWeights;
+	/**
+	 * Resolve the component a weight from GetChannelBlendWeights() was computed for
+	 * @return Null if the channel or slot no longer exists
+	 */
+	UFUNCTION(BlueprintPure, Category = DistanceBlend)
+	UDistanceBlendComponent* GetChannelBlendWeightComponent(FName Channel, const FDistanceBlendWeight& Weight) const
+	{
+		if (Channel.IsNone())
+		{
+			return GetBlendWeightComponent(Weight);
+		}
+		const FDistanceBlendChannel* BlendChannel = BlendChannels.Find(Channel);
+		return BlendChannel && BlendChannel->Components.IsValidIndex(Weight.Slot) ? BlendChannel->Components[Weight.Slot] : nullptr;
 	}
 };